@@ -1,5 +1,7 @@
-/* This header file declares functions for the linked list implementation of a symbol table, including SymTable_new, SymTable_free, 
-SymTable_getLength, SymTable_put, SymTable_replace, SymTable_contains, SymTable_get, SymTable_remove, and SymTable_map. */
+/* This header file declares functions for the implementations of a symbol table, including SymTable_new, SymTable_free, 
+SymTable_getLength, SymTable_put, SymTable_replace, SymTable_contains, SymTable_get, SymTable_remove, and SymTable_map. 
+Link exactly one of symtablelist.c (linked list), symtablehash.c (separate chaining) or symtableswiss.c (open addressing),
+the last two together with symtablehashfn.c. */
 #ifndef SYMTABLE_H
 #define SYMTABLE_H
 #include <stddef.h>
@@ -8,19 +10,131 @@ SymTable_getLength, SymTable_put, SymTable_replace, SymTable_contains, SymTable_
 are void pointers. */
 typedef struct SymTable *SymTable_T;
 
+/* SymTable_Iter is a cursor over the bindings of a symbol table, declared by the caller and set up by
+SymTable_iterBegin. Its fields belong to the implementation and must not be used directly. */
+typedef struct SymTable_Iter {
+  /* The table being traversed. */
+  SymTable_T oSymTable;
+  /* The bucket or slot the cursor is in. */
+  size_t uIndex;
+  /* The link that points at the current binding, where the implementation has one. */
+  void *pvLink;
+  /* The current binding, or NULL before the first call to SymTable_iterNext and after SymTable_iterRemoveCurrent. */
+  void *pvCurrent;
+  /* 1 once SymTable_iterRemoveCurrent has removed a binding, so that only such a traversal shrinks the table at its
+  end, or 0 before. */
+  int iRemoved;
+/* End of SymTable_Iter struct definition. */
+} SymTable_Iter;
+
+/* SymTable_Hash is the hash code of a key as returned by SymTable_hashKey. It is the same for every table of the process,
+so a key hashed once can be looked up in any number of tables. */
+typedef struct SymTable_Hash {
+  /* The process-wide hash code of the key. */
+  size_t uHash;
+  /* The length of the key. */
+  size_t uLength;
+/* End of SymTable_Hash struct definition. */
+} SymTable_Hash;
+
+/* SymTable_Allocator supplies the memory of a table created by SymTable_newWithAllocator: the table itself, its bindings
+and keys, and its bucket or slot arrays. Every block goes back through pfFree with the size it was allocated with, so
+the allocator need not record sizes. */
+typedef struct SymTable_Allocator {
+  /* Returns a block of uSize bytes aligned for any type, or NULL if there is none. */
+  void *(*pfAlloc)(size_t uSize, void *pvContext);
+  /* Releases pvBlock, which pfAlloc returned for a request of uSize bytes. */
+  void (*pfFree)(void *pvBlock, size_t uSize, void *pvContext);
+  /* The context passed to every call of pfAlloc and pfFree, such as an arena or a counter. */
+  void *pvContext;
+/* End of SymTable_Allocator struct definition. */
+} SymTable_Allocator;
+
+/* The number of entries of the chain-length histogram of SymTable_Stats. */
+#define SYMTABLE_STATS_HISTOGRAM_SIZE 8
+
+/* SymTable_Stats describes the shape and memory use of a symbol table, as filled in by SymTable_getStats. A chain is the
+list of bindings a lookup may walk: a bucket of symtablehash.c, the whole list of symtablelist.c, and in symtableswiss.c
+the groups of slots a lookup probes before it reaches a binding. */
+typedef struct SymTable_Stats {
+  /* The number of bindings. */
+  size_t uLength;
+  /* The number of buckets, or of slots in symtableswiss.c, or 1 in symtablelist.c. */
+  size_t uBucketCount;
+  /* uLength divided by uBucketCount. */
+  double dLoadFactor;
+  /* The length of the longest chain. */
+  size_t uMaxChain;
+  /* The average length of the non-empty chains. */
+  double dAvgChain;
+  /* The average number of keys a successful lookup compares, or in symtableswiss.c the average number of groups it
+  probes. */
+  double dAvgProbe;
+  /* auChainHistogram[i] is the number of buckets whose chain holds i bindings, the last entry counting all longer ones.
+  In symtableswiss.c it is the number of bindings found in the (i + 1)th group probed. */
+  size_t auChainHistogram[SYMTABLE_STATS_HISTOGRAM_SIZE];
+  /* The number of times the table grew its bucket or slot array. */
+  size_t uExpansions;
+  /* The bytes taken by the table structure itself. */
+  size_t uTableBytes;
+  /* The bytes taken by bucket arrays, or by the control and slot arrays of symtableswiss.c. */
+  size_t uBucketBytes;
+  /* The bytes taken by nodes, not counting their keys. For a table created by SymTable_newArena, the bytes of its
+  slabs not taken by keys, free space included. */
+  size_t uNodeBytes;
+  /* The bytes taken by the keys the table copied, with their null characters. Borrowed keys take none. */
+  size_t uKeyBytes;
+/* End of SymTable_Stats struct definition. */
+} SymTable_Stats;
+
 /* Creates a new symbol table and returns a pointer to it */
 SymTable_T SymTable_new(void);
 
+/* Creates a new symbol table that can hold uCapacity bindings without growing, and returns a pointer to it, or NULL if
+there is insufficient memory. */
+SymTable_T SymTable_newWithCapacity(size_t uCapacity);
+
+/* Creates a new symbol table whose bindings are carved out of large slabs of memory instead of being allocated one by one,
+and returns a pointer to it. Removed bindings are recycled by later puts, and SymTable_free releases the whole table
+with one free per slab. symtablelist.c and symtableswiss.c return an ordinary table. */
+SymTable_T SymTable_newArena(void);
+
+/* Creates a new symbol table whose memory comes from the allocator *poAllocator, which is copied, and returns a pointer
+to it, or NULL if there is insufficient memory. A table whose allocator releases all of its memory at once, such as a
+per-request arena whose pfFree does nothing, may be dropped with that memory instead of being passed to SymTable_free. */
+SymTable_T SymTable_newWithAllocator(const SymTable_Allocator *poAllocator);
+
 /* Frees all the memory taken by oSymTable */
 void SymTable_free(SymTable_T oSymTable);
 
 /* Returns the number of bindings in oSymTable */
 size_t SymTable_getLength(SymTable_T oSymTable);
 
+/* Grows oSymTable once so that it can hold uCapacity bindings in total without growing again. Returns 1 if successful,
+or 0 if there is insufficient memory, in which case oSymTable is unchanged. */
+int SymTable_reserve(SymTable_T oSymTable, size_t uCapacity);
+
+/* Shrinks oSymTable to the smallest size that holds its current bindings, giving back the memory left over from earlier,
+larger contents. Tables also shrink on their own as bindings are removed; this is for callers that know the table has
+just lost most of its bindings. */
+void SymTable_compact(SymTable_T oSymTable);
+
 /* Returns 1 if a new binding with key pcKey and value pvValue was successfully added to oSymTable, returns 0 if it was unsuccessful */
 int SymTable_put(SymTable_T oSymTable,
   const char *pcKey, const void *pvValue);
 
+/* Behaves like SymTable_put, but the new binding points to pcKey instead of copying it, saving an allocation and a copy
+per binding. The caller must keep pcKey alive and unchanged for as long as it is bound in oSymTable, as with keys that
+live in a string pool or a mapped file. */
+int SymTable_putBorrowed(SymTable_T oSymTable,
+  const char *pcKey, const void *pvValue);
+
+/* Returns a pointer to the value bound to pcKey in oSymTable, first adding a binding of pcKey to pvValue if there is none.
+The value can be read and replaced through the pointer, which stays valid until the next call that adds or removes a
+binding of oSymTable. Returns NULL if a new binding could not be added due to insufficient memory. */
+void **SymTable_getOrPut(SymTable_T oSymTable,
+  const char *pcKey, const void *pvValue);
+
 /* Replaces the value bound to pcKey with pvValue in oSymTable. */
 void *SymTable_replace(SymTable_T oSymTable,
   const char *pcKey, const void *pvValue);
@@ -31,13 +145,131 @@ int SymTable_contains(SymTable_T oSymTable, const char *pcKey);
 /* Returns the value bound to pcKey or NULL if not found in oSymTable. */
 void *SymTable_get(SymTable_T oSymTable, const char *pcKey);
 
+/* Looks up the uCount keys of the array apcKeys in oSymTable at once, storing the value bound to apcKeys[i], or NULL if
+there is none, in apvValues[i]. The lookups of a batch are interleaved so that their cache misses overlap, which makes
+this faster than uCount calls to SymTable_get on tables much larger than the cache. Returns the number of keys found.
+symtablelist.c simply looks the keys up one by one. */
+size_t SymTable_getMany(SymTable_T oSymTable,
+  const char * const *apcKeys, size_t uCount, void **apvValues);
+
+/* Hashes pcKey once for use with SymTable_putHashed, SymTable_replaceHashed, SymTable_containsHashed, SymTable_getHashed
+and SymTable_removeHashed on any table. The hash code is only valid within the current process. symtablelist.c, which
+never hashes, gives every key the hash code 0. */
+SymTable_Hash SymTable_hashKey(const char *pcKey);
+
+/* Behaves like SymTable_put, with oHash the result of SymTable_hashKey for pcKey. */
+int SymTable_putHashed(SymTable_T oSymTable,
+  const char *pcKey, SymTable_Hash oHash, const void *pvValue);
+
+/* Behaves like SymTable_replace, with oHash the result of SymTable_hashKey for pcKey. */
+void *SymTable_replaceHashed(SymTable_T oSymTable,
+  const char *pcKey, SymTable_Hash oHash, const void *pvValue);
+
+/* Behaves like SymTable_contains, with oHash the result of SymTable_hashKey for pcKey. */
+int SymTable_containsHashed(SymTable_T oSymTable,
+  const char *pcKey, SymTable_Hash oHash);
+
+/* Behaves like SymTable_get, with oHash the result of SymTable_hashKey for pcKey. */
+void *SymTable_getHashed(SymTable_T oSymTable,
+  const char *pcKey, SymTable_Hash oHash);
+
+/* Behaves like SymTable_remove, with oHash the result of SymTable_hashKey for pcKey. */
+void *SymTable_removeHashed(SymTable_T oSymTable,
+  const char *pcKey, SymTable_Hash oHash);
+
+/* Returns the atom for pcKey: a copy of pcKey kept for the life of the process, shared by everyone who interns an equal
+key, so that equal atoms are the same pointer. Returns NULL if there is insufficient memory. Any thread may intern
+keys. */
+const char *SymTable_intern(const char *pcKey);
+
+/* Behaves like SymTable_put, with pcAtom an atom returned by SymTable_intern. The binding points to pcAtom instead of
+copying it, and the key is not hashed again. */
+int SymTable_putAtom(SymTable_T oSymTable,
+  const char *pcAtom, const void *pvValue);
+
+/* Behaves like SymTable_contains, with pcAtom an atom returned by SymTable_intern. A binding added with
+SymTable_putAtom is recognized by its pointer alone. */
+int SymTable_containsAtom(SymTable_T oSymTable, const char *pcAtom);
+
+/* Behaves like SymTable_get, with pcAtom an atom returned by SymTable_intern. A binding added with SymTable_putAtom is
+recognized by its pointer alone. */
+void *SymTable_getAtom(SymTable_T oSymTable, const char *pcAtom);
+
 /* Removes the value bound to pcKey, returns the removed value or NULL if not found in oSymTable. */
 void *SymTable_remove(SymTable_T oSymTable, const char *pcKey);
 
+/* Behaves like SymTable_put, with the key given as the uLength bytes at pvKey instead of a string, so that a slice of a
+larger buffer can be bound without first copying it to add a null character. The key may hold any bytes, null
+characters included, and equals a string key of the same bytes. The table stores a copy of the key followed by a null
+character; SymTable_map and SymTable_iterKey give such a key as a string, which ends at its first null character, and
+SymTable_iterKeyLength gives its full length. */
+int SymTable_putN(SymTable_T oSymTable,
+  const void *pvKey, size_t uLength, const void *pvValue);
+
+/* Behaves like SymTable_contains, with the key given as the uLength bytes at pvKey. */
+int SymTable_containsN(SymTable_T oSymTable, const void *pvKey, size_t uLength);
+
+/* Behaves like SymTable_get, with the key given as the uLength bytes at pvKey. */
+void *SymTable_getN(SymTable_T oSymTable, const void *pvKey, size_t uLength);
+
+/* Behaves like SymTable_remove, with the key given as the uLength bytes at pvKey. */
+void *SymTable_removeN(SymTable_T oSymTable, const void *pvKey, size_t uLength);
+
+/* Fills *poStats with the shape and memory use of oSymTable. This walks every binding, so it is meant for occasional
+monitoring rather than for every lookup. */
+void SymTable_getStats(SymTable_T oSymTable, SymTable_Stats *poStats);
+
 /* Applies the function pointed to by pfApply to each binding with key pcKey and value pvValue in the oSymTable, passing an additional 
 user-specified argument pvExtra. */
 void SymTable_map(SymTable_T oSymTable,
   void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra), 
   const void *pvExtra);
 
+/* Applies the function pointed to by pfApply to each binding of oSymTable, like SymTable_map, but gives each key as the
+uLength bytes at pvKey, as stored by SymTable_putN, null characters included. Like SymTable_map, it leaves oSymTable
+unchanged, so other threads may read the table meanwhile. */
+void SymTable_mapN(SymTable_T oSymTable,
+  void (*pfApply)(const void *pvKey, size_t uLength, void *pvValue, void *pvExtra),
+  const void *pvExtra);
+
+/* Applies the function pointed to by pfApply to each binding of oSymTable, like SymTable_map, but spreads the bindings
+over up to uThreadCount threads, the calling thread included. pfApply runs concurrently on different bindings, so it must
+be safe to call from several threads at once, including any use it makes of pvExtra; it must not add or remove bindings
+of oSymTable. Returns once every binding has been visited. symtablelist.c always uses the calling thread alone. */
+void SymTable_mapParallel(SymTable_T oSymTable,
+  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+  const void *pvExtra, size_t uThreadCount);
+
+/* Removes from oSymTable every binding for which the function pointed to by pfPred returns nonzero, in a single sweep,
+passing it each key, value and the additional user-specified argument pvExtra. If pfOnRemoved is not NULL it is called
+the same way with each binding just before the binding is removed, so that the value can be released. Returns the number
+of bindings removed. */
+size_t SymTable_removeIf(SymTable_T oSymTable,
+  int (*pfPred)(const char *pcKey, void *pvValue, void *pvExtra),
+  const void *pvExtra,
+  void (*pfOnRemoved)(const char *pcKey, void *pvValue, void *pvExtra));
+
+/* Sets up poIter to traverse the bindings of oSymTable, in no particular order. The traversal is valid until a binding
+is added to oSymTable or removed from it other than through SymTable_iterRemoveCurrent. */
+void SymTable_iterBegin(SymTable_T oSymTable, SymTable_Iter *poIter);
+
+/* Moves poIter to the next binding of its table. Returns 1 if there is one, or 0 once every binding has been visited. */
+int SymTable_iterNext(SymTable_Iter *poIter);
+
+/* Returns the key of the current binding of poIter. */
+const char *SymTable_iterKey(const SymTable_Iter *poIter);
+
+/* Returns the length of the key of the current binding of poIter, not counting its terminating null character. Unlike
+strlen of SymTable_iterKey, this counts every byte of a key added by SymTable_putN, null characters included. */
+size_t SymTable_iterKeyLength(const SymTable_Iter *poIter);
+
+/* Returns the value of the current binding of poIter. */
+void *SymTable_iterValue(const SymTable_Iter *poIter);
+
+/* Removes the current binding of poIter from its table without searching for it again, and returns its value. The
+following SymTable_iterNext moves to the binding after it. Any shrinking this calls for is put off until the traversal
+reaches the end; a traversal that removes nothing never shrinks the table, so room set aside by SymTable_reserve or
+SymTable_newWithCapacity is kept. */
+void *SymTable_iterRemoveCurrent(SymTable_Iter *poIter);
+
 #endif
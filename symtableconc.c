@@ -0,0 +1,642 @@
+/* SymTable Concurrent Hash Table Implementation:
+This file implements a symbol table of string keys and void pointer values that many threads may use at once, using a
+hash table with separate chaining.
+
+Writers lock one of STRIPE_COUNT mutexes, chosen by the low bits of the key's hash code. Bucket counts are multiples of
+STRIPE_COUNT, so every bucket belongs to exactly one stripe at every table size. Readers take no lock: a new node is
+fully built before it is linked in, and an unlinked node keeps its next pointer, so a reader walking a chain always
+follows valid links. Unlinked nodes, and bucket arrays replaced by an expansion, are retired rather than freed. They are
+freed only after every reader that might still hold a pointer to them has finished, which writers detect by flipping
+an epoch and waiting for the readers counted under the old one to drain.
+
+An expansion copies the table into an array twice as large one stripe at a time, holding only that stripe's lock, so
+writers on other stripes and all readers carry on. Each stripe has a flag, published with the new array, that tells
+readers and writers which array currently holds that stripe's bindings. Copying rather than relinking the nodes leaves
+the old chains intact for readers still walking them; relinking would let such a reader follow a moved node into the
+new array and miss the rest of its old chain. The price is that an expansion briefly holds two copies of every binding.
+
+A replace cannot be lost to an expansion: the copy of a stripe and every change to it hold the stripe's lock, and a
+writer decides which array to change under that lock, so a change made before the copy is copied and a change made
+after it goes to the new node.
+
+This file uses the GCC and Clang __atomic builtins. */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "symtableconc.h"
+#include "symtablehashfn.h"
+#include <assert.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* The number of writer locks. A power of two no larger than INITIAL_BUCKET_COUNT. */
+#define STRIPE_COUNT 64
+/* The number of buckets of a new table. Bucket counts are always powers of two, and the table doubles once it holds
+more bindings than buckets. */
+#define INITIAL_BUCKET_COUNT 512
+/* The number of reader counters. Each thread uses the one picked by the address of its stack, so that readers on
+different threads rarely share a counter. A power of two. */
+#define READER_SLOTS 64
+/* The assumed size of a cache line, used to keep counters and locks that different threads update apart. */
+#define CACHE_LINE 64
+/* The number of retired allocations that makes a writer wait for readers and free them. */
+#define RETIRE_BATCH 256
+
+/* Defines a linked list node that stores a key-value pair for separate chaining. The node and its key are one
+allocation. Only next and value change once a node is linked in. */
+typedef struct Node {
+  /* Pointer to the next node in the linked list. */
+  struct Node *next;
+  /* The value of this binding, stored as a generic pointer. */
+  void *value;
+  /* The full hash code of key. */
+  size_t hash;
+  /* The length of key, not counting its terminating null character. */
+  size_t keyLength;
+  /* The key of this binding, stored inline after the other fields. */
+  char key[];
+/* End of Node struct definition. */
+} Node;
+
+/* Defines an array of buckets. */
+typedef struct BucketArray {
+  /* The number of buckets, a power of two and a multiple of STRIPE_COUNT. */
+  size_t count;
+  /* The first node of each bucket's chain. */
+  Node *heads[];
+/* End of BucketArray struct definition. */
+} BucketArray;
+
+/* Defines which bucket arrays hold the bindings of a table. A state never changes once published, apart from its
+migrated flags; an expansion publishes a new one instead. */
+typedef struct State {
+  /* The array holding every binding when next is NULL, and the bindings of stripes not yet migrated otherwise. */
+  BucketArray *current;
+  /* The array being filled by an expansion, or NULL if none is in progress. */
+  BucketArray *next;
+  /* Whether each stripe's bindings have been copied into next. */
+  unsigned char migrated[STRIPE_COUNT];
+/* End of State struct definition. */
+} State;
+
+/* Defines a writer lock, padded so that neighbouring locks do not share a cache line. */
+typedef union Stripe {
+  /* The lock itself. */
+  pthread_mutex_t mutex;
+  /* Padding. */
+  char pad[CACHE_LINE];
+/* End of Stripe union definition. */
+} Stripe;
+
+/* Defines a pair of reader counters, one for each parity of the epoch, padded to a cache line. */
+typedef union ReaderSlot {
+  /* The number of readers inside the table that entered during an even and an odd epoch. */
+  size_t counts[2];
+  /* Padding. */
+  char pad[CACHE_LINE];
+/* End of ReaderSlot union definition. */
+} ReaderSlot;
+
+/* Defines a concurrent symbol table structure. */
+struct SymTableConc {
+  /* The writer locks. */
+  Stripe stripes[STRIPE_COUNT];
+  /* The reader counters. */
+  ReaderSlot readers[READER_SLOTS];
+  /* The current state, read without a lock and replaced only by an expansion. */
+  State *state;
+  /* The total number of key-value bindings in the symbol table. */
+  size_t length;
+  /* The random seed of this table's hash function, so that colliding keys cannot be crafted in advance. */
+  uint64_t seed;
+  /* The epoch; readers count themselves under its parity. */
+  size_t epoch;
+  /* Held by the one thread expanding the table. */
+  pthread_mutex_t resizeMutex;
+  /* Held while the epoch is flipped and the old readers drain. */
+  pthread_mutex_t reclaimMutex;
+  /* Guards retired, retiredCount and retiredCapacity. */
+  pthread_mutex_t retireMutex;
+  /* Allocations no longer reachable from the table, waiting for the readers that might hold them to finish. */
+  void **retired;
+  /* The number of allocations in retired. */
+  size_t retiredCount;
+  /* The number of allocations retired has room for. */
+  size_t retiredCapacity;
+};
+
+/* Return a hash code for pcKey in oSymTable and store the length of pcKey in *puLength. */
+static size_t SymTableConc_hash(SymTableConc_T oSymTable, const char *pcKey, size_t *puLength)
+{
+   assert(pcKey != NULL);
+
+   *puLength = strlen(pcKey);
+   return (size_t) SymTableHashFn_bytes(pcKey, *puLength, oSymTable -> seed);
+}
+
+/* Returns 1 if node holds the key pcKey, whose hash code is uHash and length is uLength, or 0 if it doesn't. */
+static int SymTableConc_keyEquals(const Node *node, const char *pcKey, size_t uHash, size_t uLength) {
+  return node -> hash == uHash && node -> keyLength == uLength && memcmp (node -> key, pcKey, uLength) == 0;
+}
+
+/* Returns a new node for the key pcKey of length uLength with hash code uHash and value pvValue, not yet linked to
+anything, or NULL if there is insufficient memory. */
+static Node *SymTableConc_newNode(const char *pcKey, size_t uLength, size_t uHash, void *pvValue) {
+  Node *node = (Node *) malloc (offsetof (Node, key) + uLength + 1);
+  if (node == NULL) {
+    return NULL;
+  }
+  memcpy (node -> key, pcKey, uLength + 1);
+  node -> keyLength = uLength;
+  node -> hash = uHash;
+  node -> value = pvValue;
+  node -> next = NULL;
+  return node;
+}
+
+/* Returns a new array of uCount empty buckets, or NULL if there is insufficient memory. */
+static BucketArray *SymTableConc_newArray(size_t uCount) {
+  BucketArray *array;
+  if (uCount > ((size_t) -1 - offsetof (BucketArray, heads)) / sizeof (Node *)) {
+    return NULL;
+  }
+  array = (BucketArray *) calloc (1, offsetof (BucketArray, heads) + uCount * sizeof (Node *));
+  if (array == NULL) {
+    return NULL;
+  }
+  array -> count = uCount;
+  return array;
+}
+
+/* Returns the array of state that holds the bindings of stripe uStripe. */
+static BucketArray *SymTableConc_arrayFor(State *state, size_t uStripe) {
+  if (state -> next != NULL && __atomic_load_n (&state -> migrated [uStripe], __ATOMIC_ACQUIRE)) {
+    return state -> next;
+  }
+  return state -> current;
+}
+
+/* Marks the calling thread as reading oSymTable, so that nothing it can reach is freed until it calls
+SymTableConc_exit. Returns the counter it was counted under, to be passed to SymTableConc_exit. */
+static size_t *SymTableConc_enter(SymTableConc_T oSymTable) {
+  char cStackMarker;
+  size_t uSlot;
+  size_t uEpoch;
+  size_t *puCount;
+
+  uSlot = (size_t) (((uint64_t) ((uintptr_t) &cStackMarker >> 12) * 0x9e3779b97f4a7c15ULL) >> 32) & (READER_SLOTS - 1);
+  for (;;) {
+    uEpoch = __atomic_load_n (&oSymTable -> epoch, __ATOMIC_SEQ_CST);
+    puCount = &oSymTable -> readers [uSlot].counts [uEpoch & 1];
+    __atomic_fetch_add (puCount, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n (&oSymTable -> epoch, __ATOMIC_SEQ_CST) == uEpoch) {
+      return puCount;
+    }
+    /* A writer flipped the epoch in between and may already have stopped waiting for this counter. */
+    __atomic_fetch_sub (puCount, 1, __ATOMIC_RELEASE);
+  }
+}
+
+/* Marks the calling thread as no longer reading oSymTable, given the counter SymTableConc_enter returned. */
+static void SymTableConc_exit(size_t *puCount) {
+  __atomic_fetch_sub (puCount, 1, __ATOMIC_RELEASE);
+}
+
+/* Waits until every reader that entered oSymTable before this call has left. The calling thread must not be reading
+oSymTable itself. */
+static void SymTableConc_synchronize(SymTableConc_T oSymTable) {
+  size_t uParity;
+  size_t i;
+
+  pthread_mutex_lock (&oSymTable -> reclaimMutex);
+  uParity = __atomic_fetch_add (&oSymTable -> epoch, 1, __ATOMIC_SEQ_CST) & 1;
+  for (i = 0; i < READER_SLOTS; i++) {
+    while (__atomic_load_n (&oSymTable -> readers [i].counts [uParity], __ATOMIC_ACQUIRE) != 0) {
+      sched_yield ();
+    }
+  }
+  pthread_mutex_unlock (&oSymTable -> reclaimMutex);
+}
+
+/* Frees pv, which is no longer reachable from oSymTable, once no reader can still be using it. The calling thread must
+not be reading oSymTable. */
+static void SymTableConc_retire(SymTableConc_T oSymTable, void *pv) {
+  void **newRetired;
+  size_t newCapacity;
+
+  pthread_mutex_lock (&oSymTable -> retireMutex);
+  if (oSymTable -> retiredCount == oSymTable -> retiredCapacity) {
+    newCapacity = oSymTable -> retiredCapacity == 0 ? RETIRE_BATCH : 2 * oSymTable -> retiredCapacity;
+    newRetired = (void **) realloc (oSymTable -> retired, newCapacity * sizeof (void *));
+    if (newRetired == NULL) {
+      pthread_mutex_unlock (&oSymTable -> retireMutex);
+      SymTableConc_synchronize (oSymTable);
+      free (pv);
+      return;
+    }
+    oSymTable -> retired = newRetired;
+    oSymTable -> retiredCapacity = newCapacity;
+  }
+  oSymTable -> retired [oSymTable -> retiredCount++] = pv;
+  pthread_mutex_unlock (&oSymTable -> retireMutex);
+}
+
+/* Frees the retired allocations of oSymTable once no reader can still be using them, if there are at least
+RETIRE_BATCH of them or iForce is 1. The calling thread must not be reading oSymTable. */
+static void SymTableConc_reclaim(SymTableConc_T oSymTable, int iForce) {
+  void **retired;
+  size_t retiredCount;
+  size_t i;
+
+  pthread_mutex_lock (&oSymTable -> retireMutex);
+  if (oSymTable -> retiredCount == 0 || (!iForce && oSymTable -> retiredCount < RETIRE_BATCH)) {
+    pthread_mutex_unlock (&oSymTable -> retireMutex);
+    return;
+  }
+  retired = oSymTable -> retired;
+  retiredCount = oSymTable -> retiredCount;
+  oSymTable -> retired = NULL;
+  oSymTable -> retiredCount = 0;
+  oSymTable -> retiredCapacity = 0;
+  pthread_mutex_unlock (&oSymTable -> retireMutex);
+
+  SymTableConc_synchronize (oSymTable);
+  for (i = 0; i < retiredCount; i++) {
+    free (retired [i]);
+  }
+  free (retired);
+}
+
+/* Frees every node of the array, and the array itself. */
+static void SymTableConc_freeArray(BucketArray *array) {
+  Node *currNode;
+  Node *nextNode;
+  size_t i;
+
+  for (i = 0; i < array -> count; i++) {
+    for (currNode = array -> heads [i]; currNode != NULL; currNode = nextNode) {
+      nextNode = currNode -> next;
+      free (currNode);
+    }
+  }
+  free (array);
+}
+
+/* Copies the bindings of stripe uStripe from the current array of state into its next array. Returns 1 if successful,
+or 0 if there is insufficient memory, in which case the stripe's part of the next array is left empty. The caller holds
+the stripe's lock. */
+static int SymTableConc_migrateStripe(State *state, size_t uStripe) {
+  BucketArray *from = state -> current;
+  BucketArray *to = state -> next;
+  Node *currNode;
+  Node *copy;
+  Node *nextNode;
+  size_t i;
+  size_t newIndex;
+
+  for (i = uStripe; i < from -> count; i += STRIPE_COUNT) {
+    for (currNode = from -> heads [i]; currNode != NULL; currNode = currNode -> next) {
+      copy = SymTableConc_newNode (currNode -> key, currNode -> keyLength, currNode -> hash, currNode -> value);
+      if (copy == NULL) {
+        for (i = uStripe; i < to -> count; i += STRIPE_COUNT) {
+          for (currNode = to -> heads [i]; currNode != NULL; currNode = nextNode) {
+            nextNode = currNode -> next;
+            free (currNode);
+          }
+          to -> heads [i] = NULL;
+        }
+        return 0;
+      }
+      newIndex = copy -> hash & (to -> count - 1);
+      copy -> next = to -> heads [newIndex];
+      to -> heads [newIndex] = copy;
+    }
+  }
+  return 1;
+}
+
+/* Doubles the bucket count of oSymTable, or carries on with a doubling that an earlier call could not finish, unless
+another thread is already doing so. Each stripe is copied into the new array under its own lock, so only writers on
+that stripe wait. Once every stripe has moved, the old array and its nodes are freed as soon as the readers that might
+still be walking them have left. The calling thread must not be reading oSymTable. */
+static void SymTableConc_expand(SymTableConc_T oSymTable) {
+  State *oldState;
+  State *newState;
+  State *finalState;
+  BucketArray *newArray;
+  size_t s;
+
+  if (pthread_mutex_trylock (&oSymTable -> resizeMutex) != 0) {
+    return;
+  }
+  oldState = __atomic_load_n (&oSymTable -> state, __ATOMIC_RELAXED);
+  if (oldState -> next == NULL) {
+    if (__atomic_load_n (&oSymTable -> length, __ATOMIC_RELAXED) <= oldState -> current -> count ||
+        oldState -> current -> count > (size_t) -1 / 2) {
+      pthread_mutex_unlock (&oSymTable -> resizeMutex);
+      return;
+    }
+    newArray = SymTableConc_newArray (2 * oldState -> current -> count);
+    newState = (State *) calloc (1, sizeof (State));
+    if (newArray == NULL || newState == NULL) {
+      free (newArray);
+      free (newState);
+      pthread_mutex_unlock (&oSymTable -> resizeMutex);
+      return;
+    }
+    newState -> current = oldState -> current;
+    newState -> next = newArray;
+    __atomic_store_n (&oSymTable -> state, newState, __ATOMIC_RELEASE);
+    SymTableConc_retire (oSymTable, oldState);
+    oldState = newState;
+  }
+  finalState = (State *) calloc (1, sizeof (State));
+  if (finalState == NULL) {
+    pthread_mutex_unlock (&oSymTable -> resizeMutex);
+    return;
+  }
+
+  for (s = 0; s < STRIPE_COUNT; s++) {
+    if (oldState -> migrated [s]) {
+      continue;
+    }
+    pthread_mutex_lock (&oSymTable -> stripes [s].mutex);
+    if (!SymTableConc_migrateStripe (oldState, s)) {
+      pthread_mutex_unlock (&oSymTable -> stripes [s].mutex);
+      free (finalState);
+      pthread_mutex_unlock (&oSymTable -> resizeMutex);
+      return;
+    }
+    __atomic_store_n (&oldState -> migrated [s], 1, __ATOMIC_RELEASE);
+    pthread_mutex_unlock (&oSymTable -> stripes [s].mutex);
+  }
+
+  finalState -> current = oldState -> next;
+  finalState -> next = NULL;
+  __atomic_store_n (&oSymTable -> state, finalState, __ATOMIC_RELEASE);
+  /* No writer can reach the old array any more, and once the readers that entered before finalState was published
+  have left, no reader can either, so it is freed here in one go rather than node by node through the retire list. */
+  SymTableConc_synchronize (oSymTable);
+  SymTableConc_freeArray (oldState -> current);
+  free (oldState);
+  pthread_mutex_unlock (&oSymTable -> resizeMutex);
+  SymTableConc_reclaim (oSymTable, 1);
+}
+
+/* Creates a new concurrent symbol table and returns a pointer to it */
+SymTableConc_T SymTableConc_new(void) {
+  SymTableConc_T oSymTable;
+  size_t i;
+
+  oSymTable = (SymTableConc_T) calloc (1, sizeof (struct SymTableConc));
+  if (oSymTable == NULL) {
+    return NULL;
+  }
+  oSymTable -> state = (State *) calloc (1, sizeof (State));
+  if (oSymTable -> state != NULL) {
+    oSymTable -> state -> current = SymTableConc_newArray (INITIAL_BUCKET_COUNT);
+  }
+  if (oSymTable -> state == NULL || oSymTable -> state -> current == NULL) {
+    free (oSymTable -> state);
+    free (oSymTable);
+    return NULL;
+  }
+  for (i = 0; i < STRIPE_COUNT; i++) {
+    pthread_mutex_init (&oSymTable -> stripes [i].mutex, NULL);
+  }
+  pthread_mutex_init (&oSymTable -> resizeMutex, NULL);
+  pthread_mutex_init (&oSymTable -> reclaimMutex, NULL);
+  pthread_mutex_init (&oSymTable -> retireMutex, NULL);
+  oSymTable -> seed = SymTableHashFn_newSeed (oSymTable);
+  return oSymTable;
+}
+
+/* Frees all the memory taken by oSymTable */
+void SymTableConc_free(SymTableConc_T oSymTable) {
+  size_t i;
+  assert (oSymTable != NULL);
+
+  SymTableConc_freeArray (oSymTable -> state -> current);
+  if (oSymTable -> state -> next != NULL) {
+    SymTableConc_freeArray (oSymTable -> state -> next);
+  }
+  free (oSymTable -> state);
+  for (i = 0; i < oSymTable -> retiredCount; i++) {
+    free (oSymTable -> retired [i]);
+  }
+  free (oSymTable -> retired);
+  for (i = 0; i < STRIPE_COUNT; i++) {
+    pthread_mutex_destroy (&oSymTable -> stripes [i].mutex);
+  }
+  pthread_mutex_destroy (&oSymTable -> resizeMutex);
+  pthread_mutex_destroy (&oSymTable -> reclaimMutex);
+  pthread_mutex_destroy (&oSymTable -> retireMutex);
+  free (oSymTable);
+}
+
+/* Returns the number of bindings in oSymTable */
+size_t SymTableConc_getLength(SymTableConc_T oSymTable) {
+  assert (oSymTable != NULL);
+  return __atomic_load_n (&oSymTable -> length, __ATOMIC_RELAXED);
+}
+
+/* Returns the node for pcKey, whose hash code is uHash and length is uLength, in oSymTable, or NULL if there is none.
+The caller is reading oSymTable or holds the lock of the key's stripe. */
+static Node *SymTableConc_find(SymTableConc_T oSymTable, const char *pcKey, size_t uHash, size_t uLength) {
+  State *state;
+  BucketArray *array;
+  Node *currNode;
+
+  state = __atomic_load_n (&oSymTable -> state, __ATOMIC_ACQUIRE);
+  array = SymTableConc_arrayFor (state, uHash & (STRIPE_COUNT - 1));
+  currNode = __atomic_load_n (&array -> heads [uHash & (array -> count - 1)], __ATOMIC_ACQUIRE);
+  while (currNode != NULL) {
+    if (SymTableConc_keyEquals (currNode, pcKey, uHash, uLength)) {
+      return currNode;
+    }
+    currNode = __atomic_load_n (&currNode -> next, __ATOMIC_ACQUIRE);
+  }
+  return NULL;
+}
+
+/* Returns 1 if a new binding with key pcKey and value pvValue was successfully added to oSymTable, returns 0 if it was unsuccessful. */
+int SymTableConc_put(SymTableConc_T oSymTable, const char *pcKey, const void *pvValue) {
+  State *state;
+  BucketArray *array;
+  Node *newNode;
+  Node **bucket;
+  size_t *puCount;
+  size_t uHash;
+  size_t uLength;
+  size_t uStripe;
+  int iExpand;
+  assert (oSymTable != NULL);
+  assert (pcKey != NULL);
+
+  uHash = SymTableConc_hash (oSymTable, pcKey, &uLength);
+  uStripe = uHash & (STRIPE_COUNT - 1);
+  puCount = SymTableConc_enter (oSymTable);
+  pthread_mutex_lock (&oSymTable -> stripes [uStripe].mutex);
+  if (SymTableConc_find (oSymTable, pcKey, uHash, uLength) != NULL) {
+    pthread_mutex_unlock (&oSymTable -> stripes [uStripe].mutex);
+    SymTableConc_exit (puCount);
+    return 0;
+  }
+  newNode = SymTableConc_newNode (pcKey, uLength, uHash, (void *) pvValue);
+  if (newNode == NULL) {
+    pthread_mutex_unlock (&oSymTable -> stripes [uStripe].mutex);
+    SymTableConc_exit (puCount);
+    return 0;
+  }
+  state = __atomic_load_n (&oSymTable -> state, __ATOMIC_ACQUIRE);
+  array = SymTableConc_arrayFor (state, uStripe);
+  bucket = &array -> heads [uHash & (array -> count - 1)];
+  newNode -> next = *bucket;
+  __atomic_store_n (bucket, newNode, __ATOMIC_RELEASE);
+  iExpand = __atomic_add_fetch (&oSymTable -> length, 1, __ATOMIC_RELAXED) > array -> count || state -> next != NULL;
+  pthread_mutex_unlock (&oSymTable -> stripes [uStripe].mutex);
+  SymTableConc_exit (puCount);
+
+  if (iExpand) {
+    SymTableConc_expand (oSymTable);
+  }
+  return 1;
+}
+
+/* Replaces the value bound to pcKey with pvValue in oSymTable. */
+void *SymTableConc_replace(SymTableConc_T oSymTable, const char *pcKey, const void *pvValue) {
+  Node *node;
+  void *oldValue = NULL;
+  size_t *puCount;
+  size_t uHash;
+  size_t uLength;
+  size_t uStripe;
+  assert (oSymTable != NULL);
+  assert (pcKey != NULL);
+
+  uHash = SymTableConc_hash (oSymTable, pcKey, &uLength);
+  uStripe = uHash & (STRIPE_COUNT - 1);
+  puCount = SymTableConc_enter (oSymTable);
+  pthread_mutex_lock (&oSymTable -> stripes [uStripe].mutex);
+  node = SymTableConc_find (oSymTable, pcKey, uHash, uLength);
+  if (node != NULL) {
+    oldValue = node -> value;
+    __atomic_store_n (&node -> value, (void *) pvValue, __ATOMIC_RELEASE);
+  }
+  pthread_mutex_unlock (&oSymTable -> stripes [uStripe].mutex);
+  SymTableConc_exit (puCount);
+  return oldValue;
+}
+
+/* Returns 1 if oSymTable has a binding for pcKey, returns 0 if it doesn't */
+int SymTableConc_contains(SymTableConc_T oSymTable, const char *pcKey) {
+  size_t *puCount;
+  size_t uHash;
+  size_t uLength;
+  int iFound;
+  assert (oSymTable != NULL);
+  assert (pcKey != NULL);
+
+  uHash = SymTableConc_hash (oSymTable, pcKey, &uLength);
+  puCount = SymTableConc_enter (oSymTable);
+  iFound = SymTableConc_find (oSymTable, pcKey, uHash, uLength) != NULL;
+  SymTableConc_exit (puCount);
+  return iFound;
+}
+
+/* Returns the value bound to pcKey or NULL if not found in oSymTable. */
+void *SymTableConc_get(SymTableConc_T oSymTable, const char *pcKey) {
+  Node *node;
+  void *value = NULL;
+  size_t *puCount;
+  size_t uHash;
+  size_t uLength;
+  assert (oSymTable != NULL);
+  assert (pcKey != NULL);
+
+  uHash = SymTableConc_hash (oSymTable, pcKey, &uLength);
+  puCount = SymTableConc_enter (oSymTable);
+  node = SymTableConc_find (oSymTable, pcKey, uHash, uLength);
+  if (node != NULL) {
+    value = __atomic_load_n (&node -> value, __ATOMIC_ACQUIRE);
+  }
+  SymTableConc_exit (puCount);
+  return value;
+}
+
+/* Removes the value bound to pcKey, returns the removed value or NULL if not found in oSymTable. */
+void *SymTableConc_remove(SymTableConc_T oSymTable, const char *pcKey) {
+  State *state;
+  BucketArray *array;
+  Node *currNode;
+  Node **link;
+  void *value;
+  size_t *puCount;
+  size_t uHash;
+  size_t uLength;
+  size_t uStripe;
+  assert (oSymTable != NULL);
+  assert (pcKey != NULL);
+
+  uHash = SymTableConc_hash (oSymTable, pcKey, &uLength);
+  uStripe = uHash & (STRIPE_COUNT - 1);
+  puCount = SymTableConc_enter (oSymTable);
+  pthread_mutex_lock (&oSymTable -> stripes [uStripe].mutex);
+  state = __atomic_load_n (&oSymTable -> state, __ATOMIC_ACQUIRE);
+  array = SymTableConc_arrayFor (state, uStripe);
+  link = &array -> heads [uHash & (array -> count - 1)];
+  for (currNode = *link; currNode != NULL; currNode = *link) {
+    if (SymTableConc_keyEquals (currNode, pcKey, uHash, uLength)) {
+      break;
+    }
+    link = &currNode -> next;
+  }
+  if (currNode == NULL) {
+    pthread_mutex_unlock (&oSymTable -> stripes [uStripe].mutex);
+    SymTableConc_exit (puCount);
+    return NULL;
+  }
+  __atomic_store_n (link, currNode -> next, __ATOMIC_RELEASE);
+  value = currNode -> value;
+  __atomic_sub_fetch (&oSymTable -> length, 1, __ATOMIC_RELAXED);
+  pthread_mutex_unlock (&oSymTable -> stripes [uStripe].mutex);
+  SymTableConc_exit (puCount);
+
+  SymTableConc_retire (oSymTable, currNode);
+  SymTableConc_reclaim (oSymTable, 0);
+  return value;
+}
+
+/* Applies the function pointed to by pfApply to each binding with key pcKey and value pvValue in the oSymTable, passing an additional
+user-specified argument pvExtra. */
+void SymTableConc_map(SymTableConc_T oSymTable, void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+                      const void *pvExtra) {
+  State *state;
+  BucketArray *array;
+  Node *currNode;
+  size_t *puCount;
+  size_t s;
+  size_t i;
+  assert (oSymTable != NULL);
+  assert (pfApply != NULL);
+
+  puCount = SymTableConc_enter (oSymTable);
+  state = __atomic_load_n (&oSymTable -> state, __ATOMIC_ACQUIRE);
+  for (s = 0; s < STRIPE_COUNT; s++) {
+    array = SymTableConc_arrayFor (state, s);
+    for (i = s; i < array -> count; i += STRIPE_COUNT) {
+      currNode = __atomic_load_n (&array -> heads [i], __ATOMIC_ACQUIRE);
+      while (currNode != NULL) {
+        (*pfApply) (currNode -> key, __atomic_load_n (&currNode -> value, __ATOMIC_ACQUIRE), (void *) pvExtra);
+        currNode = __atomic_load_n (&currNode -> next, __ATOMIC_ACQUIRE);
+      }
+    }
+  }
+  SymTableConc_exit (puCount);
+}
@@ -0,0 +1,54 @@
+/* This header file declares the functions of a symbol table that many threads may use at once: SymTableConc_new,
+SymTableConc_free, SymTableConc_getLength, SymTableConc_put, SymTableConc_replace, SymTableConc_contains,
+SymTableConc_get, SymTableConc_remove, and SymTableConc_map. They behave like their SymTable counterparts in symtable.h.
+Link symtableconc.c and symtablehashfn.c and build with -pthread. */
+#ifndef SYMTABLECONC_H
+#define SYMTABLECONC_H
+#include <stddef.h>
+
+/* SymTableConc_T is a pointer to a struct representing a symbol table that stores key-value bindings, where keys are
+unique strings and values are void pointers, and whose functions may be called from any number of threads at once.
+Lookups never wait for a lock; changes lock only the part of the table holding their key.
+
+The table doubles once it holds more bindings than buckets. A doubling copies every binding into new nodes, so while it
+runs the table takes up to twice its usual memory and makes one allocation per binding; the old nodes are freed when it
+ends, once the readers that might still be using them have left. A change made while a doubling runs is never lost. A
+lookup that overlaps a replace of the same key may return either value, as with any two calls that overlap. */
+typedef struct SymTableConc *SymTableConc_T;
+
+/* Creates a new concurrent symbol table and returns a pointer to it, or NULL if there is insufficient memory. No other
+thread may use the table until this returns. */
+SymTableConc_T SymTableConc_new(void);
+
+/* Frees all the memory taken by oSymTable. No other thread may be using the table. */
+void SymTableConc_free(SymTableConc_T oSymTable);
+
+/* Returns the number of bindings in oSymTable. While other threads are changing the table this is only a snapshot. */
+size_t SymTableConc_getLength(SymTableConc_T oSymTable);
+
+/* Returns 1 if a new binding with key pcKey and value pvValue was successfully added to oSymTable, returns 0 if pcKey
+was already bound or there is insufficient memory. */
+int SymTableConc_put(SymTableConc_T oSymTable,
+  const char *pcKey, const void *pvValue);
+
+/* Replaces the value bound to pcKey with pvValue in oSymTable and returns the old value, or NULL if pcKey is not bound. */
+void *SymTableConc_replace(SymTableConc_T oSymTable,
+  const char *pcKey, const void *pvValue);
+
+/* Returns 1 if oSymTable has a binding for pcKey, returns 0 if it doesn't */
+int SymTableConc_contains(SymTableConc_T oSymTable, const char *pcKey);
+
+/* Returns the value bound to pcKey or NULL if not found in oSymTable. */
+void *SymTableConc_get(SymTableConc_T oSymTable, const char *pcKey);
+
+/* Removes the value bound to pcKey, returns the removed value or NULL if not found in oSymTable. */
+void *SymTableConc_remove(SymTableConc_T oSymTable, const char *pcKey);
+
+/* Applies the function pointed to by pfApply to each binding with key pcKey and value pvValue in oSymTable, passing an
+additional user-specified argument pvExtra. Bindings added or removed by other threads during the traversal may or may
+not be visited. pfApply must not add or remove bindings of oSymTable. */
+void SymTableConc_map(SymTableConc_T oSymTable,
+  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+  const void *pvExtra);
+
+#endif
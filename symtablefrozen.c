@@ -0,0 +1,609 @@
+/* SymTable Frozen Implementation:
+This file implements SymTable_freeze, which copies the bindings of a symbol table into a read-only structure built
+around a minimal perfect hash function, and the functions that read that structure.
+
+A frozen table with n bindings has n slots, and every key has a slot of its own. The keys are first spread over about
+n / AVERAGE_BUCKET_SIZE buckets by their hash codes. Then, largest bucket first, each bucket is given a pilot: the
+smallest number that, mixed with the hash codes of the bucket's keys, sends each of them to a different position that
+no earlier bucket has taken. There are slightly more positions than slots, so that the last buckets placed still find
+free positions quickly; the few keys sent past the last slot are moved to the slots left free, through a small remap
+array. A lookup hashes the key once, reads its bucket's pilot, computes its slot and compares the one key stored there.
+
+The whole table is one allocation: a header followed by the values, the offsets of the keys, the remap array, the
+pilots and the keys themselves, packed end to end in slot order. The header locates each part by its offset from the
+start of the table, so the table holds no pointers into itself.
+
+That makes the table position independent, so SymTableFrozen_save writes it to a file byte for byte, with each value
+replaced by a 64-bit payload, and SymTable_openMapped maps such a file back into memory with mmap and uses the mapped
+pages as the table itself. Opening reads only the header, however large the table, and processes that map the same
+file share its pages through the page cache. */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "symtablefrozen.h"
+#include "symtablehashfn.h"
+#include <assert.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* The average number of keys per bucket. Larger buckets mean fewer pilots to store but longer searches for them. */
+#define AVERAGE_BUCKET_SIZE 4
+/* The number of slots per spare position. A table of n bindings places its keys among n + n / SLOT_SLACK + 1
+positions. */
+#define SLOT_SLACK 100
+/* The number of pilots tried for one bucket before giving up on the current seed. */
+#define MAX_PILOT 0xffffffffUL
+/* The number of seeds tried before SymTable_freeze gives up. Needing a second one is already very unlikely. */
+#define MAX_ATTEMPTS 8
+/* The first 8 bytes of every frozen table and of every file written by SymTableFrozen_save. A file written on a machine
+of the other byte order does not start with them, and so is refused. */
+#define FROZEN_MAGIC 0x315a4f5246594d53ULL
+/* The version of the layout, which changes whenever the layout does. */
+#define FROZEN_VERSION 1
+
+/* Defines the header of a frozen table, which is followed in the same allocation by the parts it locates. */
+struct SymTableFrozen {
+  /* FROZEN_MAGIC. */
+  uint64_t magic;
+  /* FROZEN_VERSION. */
+  uint64_t version;
+  /* 1 if the table is a file mapped by SymTable_openMapped, whose values are payloads, or 0 if it is an allocation made
+  by SymTable_freeze. */
+  uint64_t mapped;
+  /* The number of bindings, which is also the number of slots. */
+  uint64_t length;
+  /* The seed of the hash function. */
+  uint64_t seed;
+  /* The number of buckets, and so of pilots. */
+  uint64_t bucketCount;
+  /* The number of positions the pilots spread the keys over: length, plus the positions past the last slot. */
+  uint64_t positionCount;
+  /* The offset of the array of length 64-bit values, indexed by slot: pointers converted to integers, or payloads. */
+  uint64_t valuesOffset;
+  /* The offset of the array of length + 1 key offsets. The key of slot i starts at keyOffsets[i] in the pool and its
+  terminating null character is the byte before keyOffsets[i + 1]. */
+  uint64_t keyOffsetsOffset;
+  /* The offset of the array of positionCount - length slots, to which keys at the positions past the last slot move. */
+  uint64_t remapOffset;
+  /* The offset of the array of bucketCount 32-bit pilots. */
+  uint64_t pilotsOffset;
+  /* The offset of the pool of keys. */
+  uint64_t poolOffset;
+  /* The size of the whole table in bytes. */
+  uint64_t size;
+};
+
+/* Defines a binding of the table being frozen. */
+typedef struct Entry {
+  /* The key of the binding, owned by the table being frozen. */
+  const char *key;
+  /* The length of key, not counting its terminating null character. */
+  size_t keyLength;
+  /* The value of the binding. */
+  void *value;
+  /* The hash code of key under the seed being tried. */
+  uint64_t hash;
+  /* The slot assigned to the binding. */
+  size_t slot;
+/* End of Entry struct definition. */
+} Entry;
+
+/* Defines a bucket of bindings waiting for a pilot. */
+typedef struct Bucket {
+  /* The number of the bucket. */
+  size_t index;
+  /* The number of bindings in the bucket. */
+  size_t size;
+/* End of Bucket struct definition. */
+} Bucket;
+
+/* Returns uHash scaled from the range of 64-bit numbers down to the range 0 to uCount - 1, which is the high half of
+their product. This takes a multiply where a remainder would take a much slower divide. */
+static uint64_t SymTableFrozen_scale(uint64_t uHash, uint64_t uCount) {
+  SymTableHashFn_multiply (&uHash, &uCount);
+  return uCount;
+}
+
+/* Returns the bucket, of uBucketCount, of a key whose hash code is uHash. */
+static size_t SymTableFrozen_bucketOf(uint64_t uHash, uint64_t uBucketCount) {
+  return (size_t) SymTableFrozen_scale (uHash, uBucketCount);
+}
+
+/* Returns the position, of uPositionCount, of a key whose hash code is uHash in a bucket whose pilot is uPilot. */
+static size_t SymTableFrozen_positionOf(uint64_t uHash, uint64_t uPilot, uint64_t uPositionCount) {
+  return (size_t) SymTableFrozen_scale (SymTableHashFn_mix (uHash, 0x9e3779b97f4a7c15ULL + uPilot * 0xc2b2ae3d27d4eb4fULL),
+                                        uPositionCount);
+}
+
+/* Returns the slot of oSymTable that might hold pcKey, whose length is uLength. oSymTable is not empty. */
+static size_t SymTableFrozen_find(SymTableFrozen_T oSymTable, const char *pcKey, size_t uLength) {
+  const char *base = (const char *) oSymTable;
+  const uint32_t *pilots = (const uint32_t *) (base + oSymTable -> pilotsOffset);
+  uint64_t uHash = SymTableHashFn_bytes (pcKey, uLength, oSymTable -> seed);
+  size_t uPosition = SymTableFrozen_positionOf (uHash, pilots [SymTableFrozen_bucketOf (uHash, oSymTable -> bucketCount)],
+                                                oSymTable -> positionCount);
+  if (uPosition >= oSymTable -> length) {
+    return (size_t) ((const uint64_t *) (base + oSymTable -> remapOffset)) [uPosition - oSymTable -> length];
+  }
+  return uPosition;
+}
+
+/* Returns 1 if slot uSlot of oSymTable holds the key pcKey of length uLength, or 0 if it doesn't. */
+static int SymTableFrozen_keyEquals(SymTableFrozen_T oSymTable, size_t uSlot, const char *pcKey, size_t uLength) {
+  const char *base = (const char *) oSymTable;
+  const uint64_t *keyOffsets = (const uint64_t *) (base + oSymTable -> keyOffsetsOffset);
+  return keyOffsets [uSlot + 1] - keyOffsets [uSlot] - 1 == uLength &&
+         memcmp (base + oSymTable -> poolOffset + keyOffsets [uSlot], pcKey, uLength) == 0;
+}
+
+/* Orders two buckets by decreasing size, for qsort. */
+static int SymTableFrozen_compareBuckets(const void *pvA, const void *pvB) {
+  const Bucket *a = (const Bucket *) pvA;
+  const Bucket *b = (const Bucket *) pvB;
+  if (a -> size != b -> size) {
+    return a -> size > b -> size ? -1 : 1;
+  }
+  return a -> index < b -> index ? -1 : (a -> index > b -> index);
+}
+
+/* Finds a pilot for each of the uBucketCount buckets of the uLength entries, whose hash codes are already computed,
+spreading the entries over uPositionCount positions, and stores the pilots in pilots. Then moves the entries at
+positions past the last slot to the free slots, storing where each such position leads in remap. Sets the slot field
+of every entry to its final slot. Returns 1 if successful, or 0 if the
+current hash codes admit no pilots, which in practice happens only when two keys share a hash code, or if there is
+insufficient memory. */
+static int SymTableFrozen_place(Entry *entries, size_t uLength, size_t uPositionCount, size_t uBucketCount,
+                                uint32_t *pilots, uint64_t *remap) {
+  Bucket *buckets;
+  size_t *starts;
+  size_t *order;
+  unsigned char *taken;
+  size_t b;
+  size_t i;
+  size_t j;
+  size_t k;
+  size_t size;
+  uint64_t pilot;
+  int iPlaced = 1;
+
+  buckets = (Bucket *) calloc (uBucketCount, sizeof (Bucket));
+  starts = (size_t *) calloc (uBucketCount + 1, sizeof (size_t));
+  order = (size_t *) malloc (uLength * sizeof (size_t));
+  taken = (unsigned char *) calloc (uPositionCount, 1);
+  if (buckets == NULL || starts == NULL || order == NULL || taken == NULL) {
+    free (buckets);
+    free (starts);
+    free (order);
+    free (taken);
+    return 0;
+  }
+
+  /* Group the entries by bucket. */
+  for (b = 0; b < uBucketCount; b++) {
+    buckets [b].index = b;
+  }
+  for (i = 0; i < uLength; i++) {
+    buckets [SymTableFrozen_bucketOf (entries [i].hash, uBucketCount)].size++;
+  }
+  for (b = 0; b < uBucketCount; b++) {
+    starts [b + 1] = starts [b] + buckets [b].size;
+  }
+  for (i = 0; i < uLength; i++) {
+    b = SymTableFrozen_bucketOf (entries [i].hash, uBucketCount);
+    order [starts [b]++] = i;
+  }
+  for (b = 0; b < uBucketCount; b++) {
+    starts [b] -= buckets [b].size;
+  }
+  qsort (buckets, uBucketCount, sizeof (Bucket), SymTableFrozen_compareBuckets);
+
+  /* Place the largest buckets first, while most slots are still free. */
+  for (b = 0; b < uBucketCount && buckets [b].size > 0 && iPlaced; b++) {
+    size = buckets [b].size;
+    /* No pilot separates two keys with the same hash code. */
+    for (k = 1; k < size && iPlaced; k++) {
+      for (j = 0; j < k; j++) {
+        if (entries [order [starts [buckets [b].index] + j]].hash == entries [order [starts [buckets [b].index] + k]].hash) {
+          iPlaced = 0;
+          break;
+        }
+      }
+    }
+    if (!iPlaced) {
+      break;
+    }
+    for (pilot = 0; pilot <= MAX_PILOT; pilot++) {
+      for (k = 0; k < size; k++) {
+        i = order [starts [buckets [b].index] + k];
+        entries [i].slot = SymTableFrozen_positionOf (entries [i].hash, pilot, uPositionCount);
+        if (taken [entries [i].slot]) {
+          break;
+        }
+        for (j = 0; j < k; j++) {
+          if (entries [order [starts [buckets [b].index] + j]].slot == entries [i].slot) {
+            break;
+          }
+        }
+        if (j < k) {
+          break;
+        }
+      }
+      if (k == size) {
+        break;
+      }
+    }
+    if (pilot > MAX_PILOT) {
+      iPlaced = 0;
+      break;
+    }
+    pilots [buckets [b].index] = (uint32_t) pilot;
+    for (k = 0; k < size; k++) {
+      taken [entries [order [starts [buckets [b].index] + k]].slot] = 1;
+    }
+  }
+
+  /* Move the entries past the last slot into the slots left free, which are exactly as many. */
+  if (iPlaced) {
+    j = 0;
+    for (i = 0; i < uLength; i++) {
+      if (entries [i].slot >= uLength) {
+        while (taken [j]) {
+          j++;
+        }
+        remap [entries [i].slot - uLength] = j;
+        entries [i].slot = j;
+        j++;
+      }
+    }
+  }
+
+  free (buckets);
+  free (starts);
+  free (order);
+  free (taken);
+  return iPlaced;
+}
+
+/* Copies the key pvKey of length uLength and the value pvValue of a binding into the next free entry of the array
+pointed to by pvExtra. The length stored with the key, rather than strlen, keeps a key added by SymTable_putN whole when
+it holds null characters. */
+static void SymTableFrozen_collect(const void *pvKey, size_t uLength, void *pvValue, void *pvExtra) {
+  Entry **pEntry = (Entry **) pvExtra;
+  (*pEntry) -> key = (const char *) pvKey;
+  (*pEntry) -> keyLength = uLength;
+  (*pEntry) -> value = pvValue;
+  (*pEntry)++;
+}
+
+/* Returns a new frozen table holding the uLength entries, already placed in slots under uSeed by the uBucketCount
+pilots and the remap array of the positions from uLength to uPositionCount, whose keys take uPoolSize bytes with their
+null characters, or NULL if there is insufficient memory. */
+static SymTableFrozen_T SymTableFrozen_build(const Entry *entries, size_t uLength, size_t uPositionCount,
+                                             const uint32_t *pilots, size_t uBucketCount, const uint64_t *remap,
+                                             uint64_t uSeed, size_t uPoolSize) {
+  SymTableFrozen_T oFrozen;
+  size_t *entryAt;
+  uint64_t *keyOffsets;
+  uint64_t *values;
+  char *pool;
+  size_t i;
+
+  entryAt = (size_t *) malloc ((uLength + 1) * sizeof (size_t));
+  oFrozen = (SymTableFrozen_T) malloc (sizeof (struct SymTableFrozen) + uLength * sizeof (uint64_t) +
+                                       (uLength + 1) * sizeof (uint64_t) + (uPositionCount - uLength) * sizeof (uint64_t) +
+                                       uBucketCount * sizeof (uint32_t) + uPoolSize);
+  if (entryAt == NULL || oFrozen == NULL) {
+    free (entryAt);
+    free (oFrozen);
+    return NULL;
+  }
+  oFrozen -> magic = FROZEN_MAGIC;
+  oFrozen -> version = FROZEN_VERSION;
+  oFrozen -> mapped = 0;
+  oFrozen -> length = uLength;
+  oFrozen -> seed = uSeed;
+  oFrozen -> bucketCount = uBucketCount;
+  oFrozen -> positionCount = uPositionCount;
+  oFrozen -> valuesOffset = sizeof (struct SymTableFrozen);
+  oFrozen -> keyOffsetsOffset = oFrozen -> valuesOffset + uLength * sizeof (uint64_t);
+  oFrozen -> remapOffset = oFrozen -> keyOffsetsOffset + (uLength + 1) * sizeof (uint64_t);
+  oFrozen -> pilotsOffset = oFrozen -> remapOffset + (uPositionCount - uLength) * sizeof (uint64_t);
+  oFrozen -> poolOffset = oFrozen -> pilotsOffset + uBucketCount * sizeof (uint32_t);
+  oFrozen -> size = oFrozen -> poolOffset + uPoolSize;
+
+  values = (uint64_t *) ((char *) oFrozen + oFrozen -> valuesOffset);
+  keyOffsets = (uint64_t *) ((char *) oFrozen + oFrozen -> keyOffsetsOffset);
+  pool = (char *) oFrozen + oFrozen -> poolOffset;
+  memcpy ((char *) oFrozen + oFrozen -> remapOffset, remap, (uPositionCount - uLength) * sizeof (uint64_t));
+  memcpy ((char *) oFrozen + oFrozen -> pilotsOffset, pilots, uBucketCount * sizeof (uint32_t));
+  for (i = 0; i < uLength; i++) {
+    entryAt [entries [i].slot] = i;
+  }
+  keyOffsets [0] = 0;
+  for (i = 0; i < uLength; i++) {
+    values [i] = (uint64_t) (uintptr_t) entries [entryAt [i]].value;
+    memcpy (pool + keyOffsets [i], entries [entryAt [i]].key, entries [entryAt [i]].keyLength + 1);
+    keyOffsets [i + 1] = keyOffsets [i] + entries [entryAt [i]].keyLength + 1;
+  }
+  free (entryAt);
+  return oFrozen;
+}
+
+/* Returns a read-only snapshot of the bindings of oSymTable. Pilots are searched for under a fresh seed each time the
+search fails, up to MAX_ATTEMPTS seeds. */
+SymTableFrozen_T SymTable_freeze(SymTable_T oSymTable) {
+  SymTableFrozen_T oFrozen = NULL;
+  Entry *entries;
+  Entry *nextEntry;
+  uint32_t *pilots;
+  uint64_t *remap;
+  size_t length;
+  size_t positionCount;
+  size_t bucketCount;
+  size_t poolSize = 0;
+  uint64_t seed = 0;
+  size_t i;
+  int iAttempt;
+  int iPlaced = 0;
+  assert (oSymTable != NULL);
+
+  length = SymTable_getLength (oSymTable);
+  positionCount = length + length / SLOT_SLACK + 1;
+  bucketCount = length / AVERAGE_BUCKET_SIZE + 1;
+  entries = (Entry *) malloc ((length + 1) * sizeof (Entry));
+  pilots = (uint32_t *) calloc (bucketCount, sizeof (uint32_t));
+  remap = (uint64_t *) calloc (positionCount - length, sizeof (uint64_t));
+  if (entries == NULL || pilots == NULL || remap == NULL) {
+    free (entries);
+    free (pilots);
+    free (remap);
+    return NULL;
+  }
+  nextEntry = entries;
+  SymTable_mapN (oSymTable, SymTableFrozen_collect, &nextEntry);
+  for (i = 0; i < length; i++) {
+    poolSize += entries [i].keyLength + 1;
+  }
+
+  for (iAttempt = 0; iAttempt < MAX_ATTEMPTS && !iPlaced; iAttempt++) {
+    seed = SymTableHashFn_newSeed (entries);
+    for (i = 0; i < length; i++) {
+      entries [i].hash = SymTableHashFn_bytes (entries [i].key, entries [i].keyLength, seed);
+    }
+    iPlaced = length == 0 || SymTableFrozen_place (entries, length, positionCount, bucketCount, pilots, remap);
+  }
+  if (iPlaced) {
+    oFrozen = SymTableFrozen_build (entries, length, positionCount, pilots, bucketCount, remap, seed, poolSize);
+  }
+  free (entries);
+  free (pilots);
+  free (remap);
+  return oFrozen;
+}
+
+/* Frees all the memory taken by oSymTable */
+void SymTableFrozen_free(SymTableFrozen_T oSymTable) {
+  assert (oSymTable != NULL);
+  if (oSymTable -> mapped) {
+    munmap ((void *) oSymTable, (size_t) oSymTable -> size);
+  }
+  else {
+    free (oSymTable);
+  }
+}
+
+/* Returns the number of bindings in oSymTable */
+size_t SymTableFrozen_getLength(SymTableFrozen_T oSymTable) {
+  assert (oSymTable != NULL);
+  return (size_t) oSymTable -> length;
+}
+
+/* Returns 1 if oSymTable has a binding for pcKey, returns 0 if it doesn't */
+int SymTableFrozen_contains(SymTableFrozen_T oSymTable, const char *pcKey) {
+  assert (pcKey != NULL);
+  return SymTableFrozen_containsN (oSymTable, pcKey, strlen (pcKey));
+}
+
+/* Returns the value bound to pcKey or NULL if not found in oSymTable. */
+void *SymTableFrozen_get(SymTableFrozen_T oSymTable, const char *pcKey) {
+  assert (pcKey != NULL);
+  return SymTableFrozen_getN (oSymTable, pcKey, strlen (pcKey));
+}
+
+/* Returns 1 if oSymTable has a binding for the uLength bytes at pvKey, returns 0 if it doesn't */
+int SymTableFrozen_containsN(SymTableFrozen_T oSymTable, const void *pvKey, size_t uLength) {
+  assert (oSymTable != NULL);
+  assert (pvKey != NULL);
+
+  if (oSymTable -> length == 0) {
+    return 0;
+  }
+  return SymTableFrozen_keyEquals (oSymTable, SymTableFrozen_find (oSymTable, (const char *) pvKey, uLength),
+                                   (const char *) pvKey, uLength);
+}
+
+/* Returns the value bound to the uLength bytes at pvKey or NULL if not found in oSymTable. */
+void *SymTableFrozen_getN(SymTableFrozen_T oSymTable, const void *pvKey, size_t uLength) {
+  size_t uSlot;
+  assert (oSymTable != NULL);
+  assert (pvKey != NULL);
+
+  if (oSymTable -> length == 0) {
+    return NULL;
+  }
+  uSlot = SymTableFrozen_find (oSymTable, (const char *) pvKey, uLength);
+  if (!SymTableFrozen_keyEquals (oSymTable, uSlot, (const char *) pvKey, uLength)) {
+    return NULL;
+  }
+  return (void *) (uintptr_t) ((const uint64_t *) ((char *) oSymTable + oSymTable -> valuesOffset)) [uSlot];
+}
+
+/* Applies the function pointed to by pfApply to each binding with key pcKey and value pvValue in the oSymTable, passing an additional
+user-specified argument pvExtra. */
+void SymTableFrozen_map(SymTableFrozen_T oSymTable, void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+                        const void *pvExtra) {
+  const char *base = (const char *) oSymTable;
+  const uint64_t *values;
+  const uint64_t *keyOffsets;
+  size_t i;
+  assert (oSymTable != NULL);
+  assert (pfApply != NULL);
+
+  values = (const uint64_t *) (base + oSymTable -> valuesOffset);
+  keyOffsets = (const uint64_t *) (base + oSymTable -> keyOffsetsOffset);
+  for (i = 0; i < oSymTable -> length; i++) {
+    (*pfApply) (base + oSymTable -> poolOffset + keyOffsets [i], (void *) (uintptr_t) values [i], (void *) pvExtra);
+  }
+}
+
+/* Writes oSymTable to the file pcFilename, replacing each value with the payload returned by pfEncode for its binding,
+and returns 1 if successful or 0 if the file cannot be written, in which case it is removed. The file is the table
+itself: the header, marked as mapped, then every other part exactly as it is in memory. */
+int SymTableFrozen_save(SymTableFrozen_T oSymTable, const char *pcFilename,
+                        uint64_t (*pfEncode)(const char *pcKey, void *pvValue, void *pvExtra), const void *pvExtra) {
+  const char *base = (const char *) oSymTable;
+  const uint64_t *values;
+  const uint64_t *keyOffsets;
+  struct SymTableFrozen header;
+  uint64_t payload;
+  FILE *psFile;
+  char *pcTempName;
+  size_t uNameLength;
+  size_t i;
+  int iSuccessful;
+  assert (oSymTable != NULL);
+  assert (pcFilename != NULL);
+  assert (pfEncode != NULL);
+
+  /* Other processes may have pcFilename mapped, so it is never truncated or rewritten in place: the table goes to a
+  temporary file beside it, which then replaces it in one rename. */
+  uNameLength = strlen (pcFilename);
+  pcTempName = (char *) malloc (uNameLength + sizeof (".tmp"));
+  if (pcTempName == NULL) {
+    return 0;
+  }
+  memcpy (pcTempName, pcFilename, uNameLength);
+  memcpy (pcTempName + uNameLength, ".tmp", sizeof (".tmp"));
+  psFile = fopen (pcTempName, "wb");
+  if (psFile == NULL) {
+    free (pcTempName);
+    return 0;
+  }
+  header = *oSymTable;
+  header.mapped = 1;
+  iSuccessful = fwrite (&header, sizeof (header), 1, psFile) == 1;
+  values = (const uint64_t *) (base + oSymTable -> valuesOffset);
+  keyOffsets = (const uint64_t *) (base + oSymTable -> keyOffsetsOffset);
+  for (i = 0; i < oSymTable -> length && iSuccessful; i++) {
+    payload = (*pfEncode) (base + oSymTable -> poolOffset + keyOffsets [i], (void *) (uintptr_t) values [i],
+                           (void *) pvExtra);
+    iSuccessful = fwrite (&payload, sizeof (payload), 1, psFile) == 1;
+  }
+  if (iSuccessful) {
+    iSuccessful = fwrite (base + oSymTable -> keyOffsetsOffset, 1, (size_t) (oSymTable -> size - oSymTable -> keyOffsetsOffset),
+                          psFile) == oSymTable -> size - oSymTable -> keyOffsetsOffset;
+  }
+  /* The data must be on disk before the rename makes it the file, or a crash could leave pcFilename empty. */
+  if (iSuccessful) {
+    iSuccessful = fflush (psFile) == 0 && fsync (fileno (psFile)) == 0;
+  }
+  if (fclose (psFile) != 0) {
+    iSuccessful = 0;
+  }
+  if (iSuccessful) {
+    iSuccessful = rename (pcTempName, pcFilename) == 0;
+  }
+  if (!iSuccessful) {
+    remove (pcTempName);
+  }
+  free (pcTempName);
+  return iSuccessful;
+}
+
+/* Freezes oSymTable, writes the frozen table to pcFilename with SymTableFrozen_save and frees it. Returns 1 if
+successful or 0 if there is insufficient memory or the file cannot be written. */
+int SymTable_save(SymTable_T oSymTable, const char *pcFilename,
+                  uint64_t (*pfEncode)(const char *pcKey, void *pvValue, void *pvExtra), const void *pvExtra) {
+  SymTableFrozen_T oFrozen;
+  int iSuccessful;
+  assert (oSymTable != NULL);
+  assert (pcFilename != NULL);
+  assert (pfEncode != NULL);
+
+  oFrozen = SymTable_freeze (oSymTable);
+  if (oFrozen == NULL) {
+    return 0;
+  }
+  iSuccessful = SymTableFrozen_save (oFrozen, pcFilename, pfEncode, pvExtra);
+  SymTableFrozen_free (oFrozen);
+  return iSuccessful;
+}
+
+/* Returns 1 if the header pointed to by psHeader describes a table saved by SymTableFrozen_save whose file takes uSize
+bytes, or 0 if it doesn't. Every part must lie where the layout puts it, inside the file. */
+static int SymTableFrozen_validHeader(const struct SymTableFrozen *psHeader, uint64_t uSize) {
+  if (psHeader -> magic != FROZEN_MAGIC || psHeader -> version != FROZEN_VERSION || psHeader -> mapped != 1 ||
+      psHeader -> size != uSize) {
+    return 0;
+  }
+  /* Bound every count by the size first, so that the offsets below cannot overflow. */
+  if (psHeader -> length >= uSize || psHeader -> positionCount < psHeader -> length ||
+      psHeader -> positionCount - psHeader -> length >= uSize || psHeader -> bucketCount == 0 ||
+      psHeader -> bucketCount >= uSize) {
+    return 0;
+  }
+  return psHeader -> valuesOffset == sizeof (struct SymTableFrozen) &&
+         psHeader -> keyOffsetsOffset == psHeader -> valuesOffset + psHeader -> length * sizeof (uint64_t) &&
+         psHeader -> remapOffset == psHeader -> keyOffsetsOffset + (psHeader -> length + 1) * sizeof (uint64_t) &&
+         psHeader -> pilotsOffset == psHeader -> remapOffset +
+                                     (psHeader -> positionCount - psHeader -> length) * sizeof (uint64_t) &&
+         psHeader -> poolOffset == psHeader -> pilotsOffset + psHeader -> bucketCount * sizeof (uint32_t) &&
+         psHeader -> poolOffset <= uSize;
+}
+
+/* Returns 1 if the pool of the mapped table oSymTable, whose header is valid, is exactly as long as its last key offset
+says, or 0 if it isn't. This reads two entries of keyOffsets, whatever the size of the table. */
+static int SymTableFrozen_validPool(SymTableFrozen_T oSymTable) {
+  const uint64_t *keyOffsets = (const uint64_t *) ((const char *) oSymTable + oSymTable -> keyOffsetsOffset);
+  return keyOffsets [0] == 0 && keyOffsets [oSymTable -> length] == oSymTable -> size - oSymTable -> poolOffset;
+}
+
+/* Maps the file pcFilename into memory read-only and returns it as a frozen table, or returns NULL if the file cannot
+be opened or mapped or its header or pool size is not valid. Only those are checked, so opening costs the same for a
+table of any size; the rest of the file is trusted to be as SymTableFrozen_save wrote it. */
+SymTableFrozen_T SymTable_openMapped(const char *pcFilename) {
+  struct SymTableFrozen header;
+  struct stat sStat;
+  void *pvMap;
+  int iFile;
+  assert (pcFilename != NULL);
+
+  iFile = open (pcFilename, O_RDONLY);
+  if (iFile < 0) {
+    return NULL;
+  }
+  if (fstat (iFile, &sStat) != 0 || (uint64_t) sStat.st_size < sizeof (header) ||
+      pread (iFile, &header, sizeof (header), 0) != (ssize_t) sizeof (header) ||
+      !SymTableFrozen_validHeader (&header, (uint64_t) sStat.st_size)) {
+    close (iFile);
+    return NULL;
+  }
+  pvMap = mmap (NULL, (size_t) sStat.st_size, PROT_READ, MAP_SHARED, iFile, 0);
+  close (iFile);
+  if (pvMap == MAP_FAILED) {
+    return NULL;
+  }
+  if (!SymTableFrozen_validPool ((SymTableFrozen_T) pvMap)) {
+    munmap (pvMap, (size_t) sStat.st_size);
+    return NULL;
+  }
+  return (SymTableFrozen_T) pvMap;
+}
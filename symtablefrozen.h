@@ -0,0 +1,70 @@
+/* This header file declares SymTable_freeze, which turns a symbol table into a read-only snapshot, the functions that
+read the snapshot: SymTableFrozen_free, SymTableFrozen_getLength, SymTableFrozen_contains, SymTableFrozen_get, their
+length-aware forms SymTableFrozen_containsN and SymTableFrozen_getN, and SymTableFrozen_map, and the functions that
+store snapshots in files: SymTableFrozen_save, SymTable_save, and SymTable_openMapped. Link symtablefrozen.c and
+symtablehashfn.c together with one of the SymTable implementations. */
+#ifndef SYMTABLEFROZEN_H
+#define SYMTABLEFROZEN_H
+#include <stddef.h>
+#include <stdint.h>
+#include "symtable.h"
+
+/* SymTableFrozen_T is a pointer to a struct representing a read-only symbol table. Its bindings never change, so any
+number of threads may read it at once without locking. */
+typedef struct SymTableFrozen *SymTableFrozen_T;
+
+/* Returns a read-only snapshot of the bindings of oSymTable, or NULL if there is insufficient memory. The snapshot
+holds its own copy of every key, at its full length even if it holds null characters, and shares the values with
+oSymTable. oSymTable is only read, so other threads may go on reading it meanwhile, and it may be freed afterwards. A
+lookup in the snapshot computes one hash code and compares one key. */
+SymTableFrozen_T SymTable_freeze(SymTable_T oSymTable);
+
+/* Frees all the memory taken by oSymTable, or unmaps it if it was opened by SymTable_openMapped */
+void SymTableFrozen_free(SymTableFrozen_T oSymTable);
+
+/* Returns the number of bindings in oSymTable */
+size_t SymTableFrozen_getLength(SymTableFrozen_T oSymTable);
+
+/* Returns 1 if oSymTable has a binding for pcKey, returns 0 if it doesn't */
+int SymTableFrozen_contains(SymTableFrozen_T oSymTable, const char *pcKey);
+
+/* Returns the value bound to pcKey or NULL if not found in oSymTable. */
+void *SymTableFrozen_get(SymTableFrozen_T oSymTable, const char *pcKey);
+
+/* Behaves like SymTableFrozen_contains, with the key given as the uLength bytes at pvKey, as for SymTable_containsN. */
+int SymTableFrozen_containsN(SymTableFrozen_T oSymTable, const void *pvKey, size_t uLength);
+
+/* Behaves like SymTableFrozen_get, with the key given as the uLength bytes at pvKey, as for SymTable_getN. */
+void *SymTableFrozen_getN(SymTableFrozen_T oSymTable, const void *pvKey, size_t uLength);
+
+/* Applies the function pointed to by pfApply to each binding with key pcKey and value pvValue in oSymTable, passing an
+additional user-specified argument pvExtra. */
+void SymTableFrozen_map(SymTableFrozen_T oSymTable,
+  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+  const void *pvExtra);
+
+/* Writes oSymTable to the file pcFilename, which SymTable_openMapped can later open on any machine of the same byte
+order. Pointers mean nothing in another process, so each value is stored as the 64-bit payload returned by pfEncode
+for its binding, such as a number or an offset into some other file, with pvExtra passed through. The table is first
+written to pcFilename with ".tmp" appended, which is then renamed over pcFilename, so processes that have the old file
+mapped keep reading it unchanged and a failed save leaves it in place. Returns 1 if successful or 0 if the file cannot
+be written. */
+int SymTableFrozen_save(SymTableFrozen_T oSymTable, const char *pcFilename,
+  uint64_t (*pfEncode)(const char *pcKey, void *pvValue, void *pvExtra),
+  const void *pvExtra);
+
+/* Freezes oSymTable and writes it to pcFilename as SymTableFrozen_save does. Returns 1 if successful or 0 if there is
+insufficient memory or the file cannot be written. */
+int SymTable_save(SymTable_T oSymTable, const char *pcFilename,
+  uint64_t (*pfEncode)(const char *pcKey, void *pvValue, void *pvExtra),
+  const void *pvExtra);
+
+/* Maps the file pcFilename, written by SymTableFrozen_save or SymTable_save, into memory and returns it as a frozen
+table, or returns NULL if the file cannot be opened or is not such a file. Lookups read the mapped pages directly, with
+nothing parsed or allocated per binding. SymTableFrozen_get and SymTableFrozen_map give each value as its saved
+payload converted to a pointer, which (uintptr_t) converts back on 64-bit machines. The file must not be changed while
+it is mapped. Opening checks only the header and the total size of the keys; the key offsets, remap array and pilots
+are trusted as written, so a file from an untrusted source can make lookups read out of bounds. */
+SymTableFrozen_T SymTable_openMapped(const char *pcFilename);
+
+#endif
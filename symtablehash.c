@@ -3,26 +3,133 @@ This file implements a symbol table of string keys and void pointer values using
 */
 
 #include "symtable.h"
+#include "symtablehashfn.h"
 #include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
+#include <pthread.h>
 
-/* Sets the initial number of buckets to be 509. */
-#define INITIAL_BUCKET_COUNT 509 
-static const size_t PRIME_BUCKET_SIZES[] = {509, 1021, 2039, 4093, 8191, 16381, 32749, 65521};
-#define NUM_PRIMES (sizeof(PRIME_BUCKET_SIZES) / sizeof(PRIME_BUCKET_SIZES[0]))
+/* Sets the number of buckets a table gets once it outgrows small mode to be 512. Bucket counts are always powers of two,
+so a bucket index is the hash code masked with the bucket count minus one, and SymTable_expand doubles the count without
+any upper limit. */
+#define INITIAL_BUCKET_COUNT 512
+/* The number of bindings a table holds in small mode, where its bindings are kept in a single bucket stored inside the
+table structure and searched linearly, before its first bucket array is allocated. */
+#define SMALL_TABLE_MAX 8
 
-/* Defines a linked list node that stores a key-value pair for separate chaining */
+/* The maximum average number of bindings per bucket before the table expands. May be overridden at compile time,
+e.g. -DSYMTABLE_MAX_LOAD_FACTOR=0.75 */
+#ifndef SYMTABLE_MAX_LOAD_FACTOR
+#define SYMTABLE_MAX_LOAD_FACTOR 1.0
+#endif
+
+/* The average number of bindings per bucket below which the table shrinks to half as many buckets, though never below
+INITIAL_BUCKET_COUNT. Keeping it well under half of SYMTABLE_MAX_LOAD_FACTOR leaves a gap between the two, so a table whose
+size hovers around a boundary does not keep expanding and shrinking. May be overridden at compile time,
+e.g. -DSYMTABLE_MIN_LOAD_FACTOR=0.25 */
+#ifndef SYMTABLE_MIN_LOAD_FACTOR
+#define SYMTABLE_MIN_LOAD_FACTOR 0.125
+#endif
+
+/* The number of non-empty buckets moved from the old bucket array to the new one by each SymTable_put, SymTable_get,
+SymTable_remove, SymTable_replace and SymTable_contains call while an expansion is in progress. 0 (the default) moves every
+bucket inside the SymTable_put that triggers the expansion; a positive value spreads the work so that no single call pays
+for the whole rehash, e.g. -DSYMTABLE_REHASH_STEP=4 */
+#ifndef SYMTABLE_REHASH_STEP
+#define SYMTABLE_REHASH_STEP 0
+#endif
+/* The number of empty old buckets a rehash step may skip per bucket it is allowed to move. */
+#define REHASH_EMPTY_VISITS 10
+
+/* The number of buckets a SymTable_mapParallel thread claims at a time: large enough that claiming is rare, small enough
+that threads which finish early keep taking work from the rest. */
+#define MAP_CHUNK_BUCKETS 4096
+
+/* The number of lookups SymTable_getMany keeps in flight at once: enough to cover the latency of a cache miss with other
+work, few enough that the prefetched lines are still in the cache when they are used. */
+#define GETMANY_BATCH 16
+
+/* Starts loading the cache line at pv ahead of its use, where the compiler supports it. */
+#if defined(__GNUC__)
+#define SYMTABLE_PREFETCH(pv) __builtin_prefetch (pv)
+#else
+#define SYMTABLE_PREFETCH(pv) ((void) (pv))
+#endif
+
+/* The bit of Node keyLength that marks a borrowed key. No key is long enough to need it. */
+#define BORROWED_BIT (~(size_t) 0 - (~(size_t) 0 >> 1))
+
+/* Defines a linked list node that stores a key-value pair for separate chaining. The node and its key are one allocation,
+unless the key is borrowed. */
 typedef struct Node {
-  /* The key of this binding, stored as a dynamically allocated array of characters. */
-  char *key; 
-  /* The value of this binding, stored as a generic pointer. */
-  void *value; 
   /* Pointer to the next node in the linked list. */
   struct Node *next; 
+  /* The value of this binding, stored as a generic pointer. */
+  void *value; 
+  /* The full hash code of key, kept so that expansion never rehashes key and chain walks can skip most key comparisons. */
+  size_t hash;
+  /* The length of the key, not counting its terminating null character, with BORROWED_BIT set if the key is borrowed:
+  an atom from SymTable_intern or a key passed to SymTable_putBorrowed, which the table points to rather than copies. */
+  size_t keyLength;
+  /* The characters of the key when the table copied it, stored inline after the other fields, or else the pointer to
+  the borrowed key. SymTable_nodeKey reads either. */
+  char chars[];
 /* End of Node struct definition. */
 } Node;
 
+/* Defines an interned key. SymTable_intern hands out pointers to chars, so the header sits just before every atom. */
+typedef struct Atom {
+  /* The process-wide hash code and length of the key, so that tables never hash an atom. */
+  SymTable_Hash oHash;
+  /* The characters of the key. */
+  char chars[];
+/* End of Atom struct definition. */
+} Atom;
+
+/* The granularity, in bytes, of the node sizes an arena hands out. Every arena node is aligned to it. */
+#define ARENA_GRANULE 16
+/* The largest node, in bytes, that an arena carves out of its shared slabs and recycles. Larger nodes get a slab of their
+own, which is freed as soon as the node is removed. */
+#define ARENA_MAX_NODE 512
+/* The number of free lists of an arena, one per multiple of ARENA_GRANULE up to ARENA_MAX_NODE. */
+#define ARENA_NUM_CLASSES (ARENA_MAX_NODE / ARENA_GRANULE + 1)
+/* The size of the first shared slab of an arena. Each later one is twice as large, up to ARENA_MAX_SLAB. */
+#define ARENA_MIN_SLAB 16384
+#define ARENA_MAX_SLAB 4194304
+
+/* Defines the header of a slab of memory out of which an arena carves nodes. */
+typedef struct Slab {
+  /* Pointer to the next slab of the arena. */
+  struct Slab *next;
+  /* Pointer to the previous slab of the arena, so that a node's own slab can be unlinked when the node is removed. */
+  struct Slab *prev;
+  /* The size of the slab in bytes, header included, as it was requested from the table's allocator. */
+  size_t size;
+/* End of Slab struct definition. */
+} Slab;
+
+/* The size of a slab header, rounded up so that the memory after it is aligned to ARENA_GRANULE. */
+#define SLAB_HEADER_SIZE ((sizeof (Slab) + ARENA_GRANULE - 1) / ARENA_GRANULE * ARENA_GRANULE)
+
+/* Defines the node allocator of a table created by SymTable_newArena. */
+typedef struct Arena {
+  /* Pointer to the first slab of the arena. */
+  Slab *slabs;
+  /* The unused tail of the current shared slab. */
+  char *free;
+  /* The number of bytes left at free. */
+  size_t freeBytes;
+  /* The size of the next shared slab to allocate. */
+  size_t nextSlabSize;
+  /* Removed nodes waiting to be reused, indexed by their size divided by ARENA_GRANULE and linked through next. */
+  Node *freeNodes[ARENA_NUM_CLASSES];
+/* End of Arena struct definition. */
+} Arena;
+
 /* Defines a symbol table structure. */
 struct SymTable {
   /* Pointer to the array of pointers to the bucket nodes. */
@@ -31,61 +138,427 @@ struct SymTable {
   size_t length; 
   /* The total number of buckets in the hash table. */
   size_t totalNumBuckets;
-  /* The current expansion size in the sequence of prime bucket sizes. */
-  size_t expandIndex;
+  /* The process-wide seed of the key hash, the same in every table, so that a SymTable_hashKey code works in any of
+  them. */
+  uint64_t keySeed;
+  /* The random seed mixed into each key hash to give this table's own hash codes, so that keys which collide in one
+  table do not collide in another. */
+  uint64_t seed;
+  /* The number of bindings above which the table expands. */
+  size_t expandThreshold;
+  /* The number of bindings below which the table shrinks, or 0 if it is already as small as it shrinks on its own. */
+  size_t shrinkThreshold;
+  /* The bucket array being migrated into buckets by an incremental rehash, or NULL if no rehash is in progress. */
+  Node **oldBuckets;
+  /* The number of buckets in oldBuckets. */
+  size_t oldNumBuckets;
+  /* The index of the next bucket of oldBuckets to migrate. Buckets before it are empty. */
+  size_t rehashIndex;
+  /* The allocator of this table's nodes, or NULL if each node is allocated on its own. */
+  Arena *arena;
+  /* The allocator of all of this table's memory, including the table itself. */
+  SymTable_Allocator allocator;
+  /* The number of times the bucket array has grown. */
+  size_t expansions;
+  /* The only bucket of a table in small mode, in which case buckets points here and totalNumBuckets is 1. */
+  Node *smallBucket;
 };
 
-/* Return a hash code for pcKey that is between 0 and uBucketCount-1, inclusive. */
-static size_t SymTable_hash(const char *pcKey, size_t uBucketCount)
+/* Defines the work shared by the threads of one SymTable_mapParallel call. */
+typedef struct MapJob {
+  /* The table being traversed. */
+  SymTable_T oSymTable;
+  /* The function applied to each binding. */
+  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra);
+  /* The additional argument passed to pfApply. */
+  void *pvExtra;
+  /* Guards next. */
+  pthread_mutex_t mutex;
+  /* The first bucket not yet claimed by a thread. */
+  size_t next;
+/* End of MapJob struct definition. */
+} MapJob;
+
+/* Returns the hash code of oSymTable for a key whose process-wide hash code, as returned by SymTable_hashKey, is
+uKeyHash. One multiply gives each table its own hash codes without hashing the key again. */
+static size_t SymTable_tableHash(SymTable_T oSymTable, size_t uKeyHash)
 {
-   const size_t HASH_MULTIPLIER = 65599;
-   size_t u;
-   size_t uHash = 0;
+   return (size_t) SymTableHashFn_mix((uint64_t) uKeyHash ^ oSymTable -> seed, 0x9e3779b97f4a7c15ULL);
+}
+
+/* Return a hash code for the uLength bytes of pvKey in oSymTable. Callers mask the hash code with the bucket count of
+the array they are indexing, minus one. */
+static size_t SymTable_hashN(SymTable_T oSymTable, const void *pvKey, size_t uLength)
+{
+   assert(pvKey != NULL);
+
+   return SymTable_tableHash(oSymTable, (size_t) SymTableHashFn_bytes(pvKey, uLength, oSymTable -> keySeed));
+}
 
+/* Return a hash code for pcKey in oSymTable and store the length of pcKey in *puLength. */
+static size_t SymTable_hash(SymTable_T oSymTable, const char *pcKey, size_t *puLength)
+{
    assert(pcKey != NULL);
 
-   for (u = 0; pcKey[u] != '\0'; u++)
-      uHash = uHash * HASH_MULTIPLIER + (size_t)pcKey[u];
+   *puLength = strlen(pcKey);
+   return SymTable_hashN(oSymTable, pcKey, *puLength);
+}
 
-   return uHash % uBucketCount;
+/* Returns the key of node, which is either stored inline or borrowed. */
+static const char *SymTable_nodeKey(const Node *node) {
+  const char *pcKey;
+  if ((node -> keyLength & BORROWED_BIT) == 0) {
+    return node -> chars;
+  }
+  memcpy ((void *) &pcKey, node -> chars, sizeof (pcKey));
+  return pcKey;
 }
 
-/* Creates a new symbol table and returns a pointer to it */
-SymTable_T SymTable_new(void) {
-    SymTable_T oSymTable = (SymTable_T) malloc (sizeof (struct SymTable));
-    if (oSymTable == NULL) {
+/* Returns 1 if node holds the key pcKey, whose hash code is uHash and length is uLength, or 0 if it doesn't. When pcKey
+is the borrowed key the node holds, such as an atom, the pointers match and the characters are never compared. */
+static int SymTable_keyEquals(const Node *node, const char *pcKey, size_t uHash, size_t uLength) {
+  const char *pcNodeKey;
+  if (node -> keyLength == uLength) {
+    return node -> hash == uHash && memcmp (node -> chars, pcKey, uLength) == 0;
+  }
+  if (node -> keyLength != (uLength | BORROWED_BIT)) {
+    return 0;
+  }
+  pcNodeKey = SymTable_nodeKey (node);
+  return pcNodeKey == pcKey || (node -> hash == uHash && memcmp (pcNodeKey, pcKey, uLength) == 0);
+}
+
+/* Returns the number of bytes stored inline in node: its key and null character, or the pointer to a borrowed key. */
+static size_t SymTable_nodeChars(const Node *node) {
+  return (node -> keyLength & BORROWED_BIT) == 0 ? node -> keyLength + 1 : sizeof (const char *);
+}
+
+/* Returns the number of bindings that uBucketCount buckets may hold before the table expands. */
+static size_t SymTable_threshold(size_t uBucketCount)
+{
+  double dThreshold = (double) uBucketCount * SYMTABLE_MAX_LOAD_FACTOR;
+  if (dThreshold < 1.0) {
+    return 1;
+  }
+  return (size_t) dThreshold;
+}
+
+/* Returns the number of bindings below which a table with uBucketCount buckets shrinks. */
+static size_t SymTable_shrinkThreshold(size_t uBucketCount)
+{
+  if (uBucketCount <= INITIAL_BUCKET_COUNT) {
+    return 0;
+  }
+  return (size_t) ((double) uBucketCount * SYMTABLE_MIN_LOAD_FACTOR);
+}
+
+/* Returns a block of uSize bytes from malloc. pvContext is unused. */
+static void *SymTable_mallocBlock(size_t uSize, void *pvContext) {
+  (void) pvContext;
+  return malloc (uSize);
+}
+
+/* Gives pvBlock back to free. uSize and pvContext are unused. */
+static void SymTable_freeBlock(void *pvBlock, size_t uSize, void *pvContext) {
+  (void) uSize;
+  (void) pvContext;
+  free (pvBlock);
+}
+
+/* The allocator of the tables that are not given one. */
+static const SymTable_Allocator oDefaultAllocator = {SymTable_mallocBlock, SymTable_freeBlock, NULL};
+
+/* Returns a block of uSize bytes from the allocator of oSymTable, or NULL if there is insufficient memory. */
+static void *SymTable_alloc(SymTable_T oSymTable, size_t uSize) {
+  return (*oSymTable -> allocator.pfAlloc) (uSize, oSymTable -> allocator.pvContext);
+}
+
+/* Gives pvBlock, a block of uSize bytes, back to the allocator of oSymTable. */
+static void SymTable_release(SymTable_T oSymTable, void *pvBlock, size_t uSize) {
+  (*oSymTable -> allocator.pfFree) (pvBlock, uSize, oSymTable -> allocator.pvContext);
+}
+
+/* Frees the bucket array aBuckets of uBucketCount buckets of oSymTable, unless it is NULL or the table's inline
+small-mode bucket. */
+static void SymTable_freeBuckets(SymTable_T oSymTable, Node **aBuckets, size_t uBucketCount) {
+  if (aBuckets != NULL && aBuckets != &oSymTable -> smallBucket) {
+    SymTable_release (oSymTable, aBuckets, uBucketCount * sizeof (Node *));
+  }
+}
+
+/* Returns the number of bytes an arena sets aside for a node with uChars characters inline. */
+static size_t SymTable_arenaNodeSize(size_t uChars) {
+  return (offsetof (Node, chars) + uChars + ARENA_GRANULE - 1) / ARENA_GRANULE * ARENA_GRANULE;
+}
+
+/* Allocates a slab of uSize bytes after its header for oSymTable and links it at the front of the slabs of its arena.
+Returns a pointer to the first usable byte of the slab, or NULL if there is insufficient memory. */
+static char *SymTable_arenaAddSlab(SymTable_T oSymTable, size_t uSize) {
+  Arena *arena = oSymTable -> arena;
+  Slab *slab = (Slab *) SymTable_alloc (oSymTable, SLAB_HEADER_SIZE + uSize);
+  if (slab == NULL) {
+    return NULL;
+  }
+  slab -> size = SLAB_HEADER_SIZE + uSize;
+  slab -> prev = NULL;
+  slab -> next = arena -> slabs;
+  if (arena -> slabs != NULL) {
+    arena -> slabs -> prev = slab;
+  }
+  arena -> slabs = slab;
+  return (char *) slab + SLAB_HEADER_SIZE;
+}
+
+/* Allocates a node of oSymTable with room for uChars characters inline, from the table's arena if it has one. Returns
+the node, or NULL if there is insufficient memory. */
+static Node *SymTable_allocNode(SymTable_T oSymTable, size_t uChars) {
+  Arena *arena = oSymTable -> arena;
+  size_t size;
+  Node *node;
+  char *slabMemory;
+
+  if (arena == NULL) {
+    return (Node *) SymTable_alloc (oSymTable, offsetof (Node, chars) + uChars);
+  }
+
+  size = SymTable_arenaNodeSize (uChars);
+  if (size > ARENA_MAX_NODE) {
+    return (Node *) (void *) SymTable_arenaAddSlab (oSymTable, size);
+  }
+
+  node = arena -> freeNodes [size / ARENA_GRANULE];
+  if (node != NULL) {
+    arena -> freeNodes [size / ARENA_GRANULE] = node -> next;
+    return node;
+  }
+
+  if (arena -> freeBytes < size) {
+    slabMemory = SymTable_arenaAddSlab (oSymTable, arena -> nextSlabSize);
+    if (slabMemory == NULL) {
       return NULL;
     }
-  
-    oSymTable -> totalNumBuckets = INITIAL_BUCKET_COUNT;
-    oSymTable -> length = 0;
-    oSymTable -> buckets = (Node **) calloc (oSymTable -> totalNumBuckets, sizeof(Node *));
-    oSymTable -> expandIndex = 0;
+    arena -> free = slabMemory;
+    arena -> freeBytes = arena -> nextSlabSize;
+    if (arena -> nextSlabSize < ARENA_MAX_SLAB) {
+      arena -> nextSlabSize *= 2;
+    }
+  }
+  node = (Node *) (void *) arena -> free;
+  arena -> free += size;
+  arena -> freeBytes -= size;
+  return node;
+}
+
+/* Frees node, which was allocated by SymTable_allocNode for oSymTable. Arena nodes go back on their free list, except for
+nodes with a slab of their own, whose slab is freed. */
+static void SymTable_freeNode(SymTable_T oSymTable, Node *node) {
+  Arena *arena = oSymTable -> arena;
+  size_t size;
+  Slab *slab;
+
+  if (arena == NULL) {
+    SymTable_release (oSymTable, node, offsetof (Node, chars) + SymTable_nodeChars (node));
+    return;
+  }
+
+  size = SymTable_arenaNodeSize (SymTable_nodeChars (node));
+  if (size > ARENA_MAX_NODE) {
+    slab = (Slab *) (void *) ((char *) node - SLAB_HEADER_SIZE);
+    if (slab -> prev != NULL) {
+      slab -> prev -> next = slab -> next;
+    }
+    else {
+      arena -> slabs = slab -> next;
+    }
+    if (slab -> next != NULL) {
+      slab -> next -> prev = slab -> prev;
+    }
+    SymTable_release (oSymTable, slab, slab -> size);
+    return;
+  }
+
+  node -> next = arena -> freeNodes [size / ARENA_GRANULE];
+  arena -> freeNodes [size / ARENA_GRANULE] = node;
+}
+
+/* Returns a pointer to the head of the bucket of oSymTable that holds keys with hash code uHash. While a rehash is in
+progress, keys whose old bucket has not been migrated yet are still found in oldBuckets. */
+static Node **SymTable_bucket(SymTable_T oSymTable, size_t uHash) {
+  size_t oldIndex;
+  if (oSymTable -> oldBuckets != NULL) {
+    oldIndex = uHash & (oSymTable -> oldNumBuckets - 1);
+    if (oldIndex >= oSymTable -> rehashIndex) {
+      return &oSymTable -> oldBuckets [oldIndex];
+    }
+  }
+  return &oSymTable -> buckets [uHash & (oSymTable -> totalNumBuckets - 1)];
+}
+
+/* Moves up to uSteps non-empty buckets of oldBuckets into buckets, skipping at most REHASH_EMPTY_VISITS empty buckets per
+step, and frees oldBuckets once all of its buckets have been moved. */
+static void SymTable_rehash(SymTable_T oSymTable, size_t uSteps) {
+  size_t emptyVisits;
+  Node *currNode;
+  Node *nextNode;
+  size_t newIndex;
+
+  if (uSteps > (size_t) -1 / REHASH_EMPTY_VISITS) {
+    emptyVisits = (size_t) -1;
+  }
+  else {
+    emptyVisits = uSteps * REHASH_EMPTY_VISITS;
+  }
 
-    if (oSymTable -> buckets == NULL) {
-      free(oSymTable);
+  while (uSteps > 0 && oSymTable -> rehashIndex < oSymTable -> oldNumBuckets) {
+    currNode = oSymTable -> oldBuckets [oSymTable -> rehashIndex];
+    if (currNode == NULL) {
+      oSymTable -> rehashIndex++;
+      if (--emptyVisits == 0) {
+        break;
+      }
+      continue;
+    }
+    while (currNode != NULL) {
+      nextNode = currNode -> next;
+      newIndex = currNode -> hash & (oSymTable -> totalNumBuckets - 1);
+      currNode -> next = oSymTable -> buckets [newIndex];
+      oSymTable -> buckets [newIndex] = currNode;
+      currNode = nextNode;
+    }
+    oSymTable -> oldBuckets [oSymTable -> rehashIndex] = NULL;
+    oSymTable -> rehashIndex++;
+    uSteps--;
+  }
+
+  if (oSymTable -> rehashIndex >= oSymTable -> oldNumBuckets) {
+    SymTable_freeBuckets (oSymTable, oSymTable -> oldBuckets, oSymTable -> oldNumBuckets);
+    oSymTable -> oldBuckets = NULL;
+    oSymTable -> oldNumBuckets = 0;
+    oSymTable -> rehashIndex = 0;
+  }
+}
+
+/* Performs one bounded step of a pending incremental rehash of oSymTable, if there is one. */
+static void SymTable_rehashStep(SymTable_T oSymTable) {
+  if (oSymTable -> oldBuckets != NULL) {
+    SymTable_rehash (oSymTable, SYMTABLE_REHASH_STEP);
+  }
+}
+
+/* Creates a new symbol table whose memory comes from *poAllocator and whose nodes come from an arena if iUseArena is 1,
+and returns a pointer to it */
+static SymTable_T SymTable_create(const SymTable_Allocator *poAllocator, int iUseArena) {
+    size_t i;
+    SymTable_T oSymTable = (SymTable_T) (*poAllocator -> pfAlloc) (sizeof (struct SymTable), poAllocator -> pvContext);
+    if (oSymTable == NULL) {
       return NULL;
     }
+
+    oSymTable -> allocator = *poAllocator;
+    oSymTable -> arena = NULL;
+    if (iUseArena) {
+      oSymTable -> arena = (Arena *) SymTable_alloc (oSymTable, sizeof (Arena));
+      if (oSymTable -> arena == NULL) {
+        SymTable_release (oSymTable, oSymTable, sizeof (struct SymTable));
+        return NULL;
+      }
+      oSymTable -> arena -> slabs = NULL;
+      oSymTable -> arena -> free = NULL;
+      oSymTable -> arena -> freeBytes = 0;
+      oSymTable -> arena -> nextSlabSize = ARENA_MIN_SLAB;
+      for (i = 0; i < ARENA_NUM_CLASSES; i++) {
+        oSymTable -> arena -> freeNodes [i] = NULL;
+      }
+    }
+  
+    oSymTable -> smallBucket = NULL;
+    oSymTable -> buckets = &oSymTable -> smallBucket;
+    oSymTable -> totalNumBuckets = 1;
+    oSymTable -> length = 0;
+    oSymTable -> keySeed = SymTableHashFn_secret ();
+    oSymTable -> seed = SymTableHashFn_newSeed (oSymTable);
+    oSymTable -> expandThreshold = SMALL_TABLE_MAX;
+    oSymTable -> shrinkThreshold = 0;
+    oSymTable -> oldBuckets = NULL;
+    oSymTable -> oldNumBuckets = 0;
+    oSymTable -> rehashIndex = 0;
+    oSymTable -> expansions = 0;
     return oSymTable;
 }
 
+/* Creates a new symbol table and returns a pointer to it */
+SymTable_T SymTable_new(void) {
+  return SymTable_create (&oDefaultAllocator, 0);
+}
+
+/* Creates a new symbol table sized for uCapacity bindings and returns a pointer to it */
+SymTable_T SymTable_newWithCapacity(size_t uCapacity) {
+  SymTable_T oSymTable = SymTable_create (&oDefaultAllocator, 0);
+  if (oSymTable == NULL) {
+    return NULL;
+  }
+  if (!SymTable_reserve (oSymTable, uCapacity)) {
+    SymTable_free (oSymTable);
+    return NULL;
+  }
+  return oSymTable;
+}
+
+/* Creates a new symbol table whose nodes are carved out of large slabs and returns a pointer to it */
+SymTable_T SymTable_newArena(void) {
+  return SymTable_create (&oDefaultAllocator, 1);
+}
+
+/* Creates a new symbol table whose memory comes from a copy of *poAllocator and returns a pointer to it */
+SymTable_T SymTable_newWithAllocator(const SymTable_Allocator *poAllocator) {
+  assert (poAllocator != NULL);
+  assert (poAllocator -> pfAlloc != NULL);
+  assert (poAllocator -> pfFree != NULL);
+  return SymTable_create (poAllocator, 0);
+}
+
 /* Frees all the memory taken by oSymTable */
 void SymTable_free(SymTable_T oSymTable) {
   Node *currNode;
   Node *nextNode;
+  Slab *currSlab;
+  Slab *nextSlab;
   size_t i;
   assert(oSymTable != NULL);
+
+  if (oSymTable -> arena != NULL) {
+    currSlab = oSymTable -> arena -> slabs;
+    while (currSlab != NULL) {
+      nextSlab = currSlab -> next;
+      SymTable_release (oSymTable, currSlab, currSlab -> size);
+      currSlab = nextSlab;
+    }
+    SymTable_release (oSymTable, oSymTable -> arena, sizeof (Arena));
+    SymTable_freeBuckets (oSymTable, oSymTable -> oldBuckets, oSymTable -> oldNumBuckets);
+    SymTable_freeBuckets (oSymTable, oSymTable -> buckets, oSymTable -> totalNumBuckets);
+    SymTable_release (oSymTable, oSymTable, sizeof (struct SymTable));
+    return;
+  }
+
   for (i = 0; i < oSymTable -> totalNumBuckets; i++) {
     currNode = oSymTable -> buckets [i];
     while (currNode != NULL) {
         nextNode = currNode -> next;
-        free (currNode -> key);
-        free (currNode);
+        SymTable_freeNode (oSymTable, currNode);
+        currNode = nextNode;
+    }
+  }
+  for (i = oSymTable -> rehashIndex; i < oSymTable -> oldNumBuckets; i++) {
+    currNode = oSymTable -> oldBuckets [i];
+    while (currNode != NULL) {
+        nextNode = currNode -> next;
+        SymTable_freeNode (oSymTable, currNode);
         currNode = nextNode;
     }
   }
-  free (oSymTable -> buckets);
-  free (oSymTable);
+  SymTable_freeBuckets (oSymTable, oSymTable -> oldBuckets, oSymTable -> oldNumBuckets);
+  SymTable_freeBuckets (oSymTable, oSymTable -> buckets, oSymTable -> totalNumBuckets);
+  SymTable_release (oSymTable, oSymTable, sizeof (struct SymTable));
 }
 
 /* Returns the number of bindings in oSymTable */
@@ -95,96 +568,232 @@ size_t SymTable_getLength(SymTable_T oSymTable) {
 }
 
 
-/* Expands the size of oSymTable if needed. */
-static void SymTable_expand(SymTable_T oSymTable) {
-    size_t newBucketCount;
+/* Moves oSymTable to a new array of uBucketCount buckets, which must be a power of two; a count of 1 puts the table back
+in small mode. The existing bindings are moved right away if iNow is 1 or the table enters or leaves small mode, and
+otherwise a few buckets at a time by later calls. Returns 1 if successful, or 0 if the new array could not be allocated,
+in which case oSymTable is unchanged. */
+static int SymTable_resize(SymTable_T oSymTable, size_t uBucketCount, int iNow) {
     Node **newBuckets;
-    Node *currBucket;
-    Node *nextBucket;
-    size_t newIndex;
-    size_t i;
   
-    if (oSymTable -> expandIndex >= NUM_PRIMES - 1 || oSymTable -> totalNumBuckets >= PRIME_BUCKET_SIZES[NUM_PRIMES - 1]) {
-        return;
+    if (oSymTable -> oldBuckets != NULL) {
+        SymTable_rehash (oSymTable, (size_t) -1);
     }
-    
-    newBucketCount = PRIME_BUCKET_SIZES [oSymTable -> expandIndex + 1];
-    
-    newBuckets = (Node **) calloc (newBucketCount, sizeof(Node *));
-    if (newBuckets == NULL) {
-        return;
+
+    if (uBucketCount == 1) {
+        newBuckets = &oSymTable -> smallBucket;
+        iNow = 1;
     }
-    
-    for (i = 0; i < oSymTable -> totalNumBuckets; i++) {
-        currBucket = oSymTable -> buckets[i];
-        while (currBucket != NULL) {
-            nextBucket = currBucket -> next;
-            newIndex = SymTable_hash (currBucket -> key, newBucketCount);
-            currBucket -> next = newBuckets [newIndex];
-            newBuckets [newIndex] = currBucket;
-            currBucket = nextBucket;
+    else {
+        newBuckets = (Node **) SymTable_alloc (oSymTable, uBucketCount * sizeof (Node *));
+        if (newBuckets == NULL) {
+            return 0;
         }
+        memset (newBuckets, 0, uBucketCount * sizeof (Node *));
     }
     
-    free (oSymTable -> buckets);
+    oSymTable -> oldBuckets = oSymTable -> buckets;
+    oSymTable -> oldNumBuckets = oSymTable -> totalNumBuckets;
+    oSymTable -> rehashIndex = 0;
+    if (uBucketCount > oSymTable -> totalNumBuckets) {
+        oSymTable -> expansions++;
+    }
     oSymTable -> buckets = newBuckets;
-    oSymTable -> totalNumBuckets = newBucketCount;
-    oSymTable -> expandIndex++;
-}
+    oSymTable -> totalNumBuckets = uBucketCount;
+    oSymTable -> expandThreshold = (uBucketCount == 1) ? SMALL_TABLE_MAX : SymTable_threshold (uBucketCount);
+    oSymTable -> shrinkThreshold = SymTable_shrinkThreshold (uBucketCount);
 
+    if (iNow || oSymTable -> oldBuckets == &oSymTable -> smallBucket) {
+        SymTable_rehash (oSymTable, (size_t) -1);
+    }
+    return 1;
+}
 
-/* Returns 1 if a new binding with key pcKey and value pvValue was successfully added to oSymTable, returns 0 if it was unsuccessful. */
-int SymTable_put(SymTable_T oSymTable, const char *pcKey, const void *pvValue) {
-  Node *newNode;
-  size_t hashIndex;
-  assert (oSymTable != NULL);
-  assert (pcKey != NULL);
+/* Expands the size of oSymTable if needed. A table in small mode gets its first bucket array of INITIAL_BUCKET_COUNT
+buckets; after that the bucket count doubles, so the table only stops growing when the bucket array can no longer be
+allocated. The existing bindings are moved into the new bucket array either right away or, with a
+positive SYMTABLE_REHASH_STEP, a few buckets at a time by later calls. */
+static void SymTable_expand(SymTable_T oSymTable) {
+    size_t newBucketCount;
   
-  if (!SymTable_contains (oSymTable, pcKey)) {
-    hashIndex = SymTable_hash (pcKey, oSymTable -> totalNumBuckets);
-    newNode = (Node*) malloc (sizeof (Node));
-    
-    if (newNode == NULL) {
-      return 0;
+    if (oSymTable -> buckets == &oSymTable -> smallBucket) {
+        newBucketCount = INITIAL_BUCKET_COUNT;
     }
-    
-    newNode -> key = malloc (strlen (pcKey) + 1);
-    
-    if (newNode -> key == NULL) {
-        free (newNode);
+    else {
+        if (oSymTable -> totalNumBuckets > (size_t) -1 / sizeof(Node *) / 2) {
+            return;
+        }
+        newBucketCount = 2 * oSymTable -> totalNumBuckets;
+    }
+    (void) SymTable_resize (oSymTable, newBucketCount, SYMTABLE_REHASH_STEP == 0);
+}
+
+/* Returns the smallest bucket count, a power of two no smaller than INITIAL_BUCKET_COUNT, that holds uCapacity bindings
+without expanding, or 0 if that count would overflow. */
+static size_t SymTable_bucketCountFor(size_t uCapacity) {
+    size_t bucketCount = INITIAL_BUCKET_COUNT;
+    while (SymTable_threshold (bucketCount) < uCapacity) {
+        if (bucketCount > (size_t) -1 / sizeof(Node *) / 2) {
+            return 0;
+        }
+        bucketCount *= 2;
+    }
+    return bucketCount;
+}
+
+/* Makes oSymTable large enough to hold uCapacity bindings without expanding. Returns 1 if successful, 0 otherwise. */
+int SymTable_reserve(SymTable_T oSymTable, size_t uCapacity) {
+    size_t bucketCount;
+    assert (oSymTable != NULL);
+
+    if (uCapacity <= oSymTable -> expandThreshold) {
+        return 1;
+    }
+    bucketCount = SymTable_bucketCountFor (uCapacity);
+    if (bucketCount == 0) {
         return 0;
     }
-    
-    strcpy(newNode -> key, pcKey);
-    newNode -> value = (void *) pvValue;
-    newNode -> next = oSymTable -> buckets [hashIndex];
-    oSymTable -> buckets [hashIndex] = newNode;
-    oSymTable -> length++;
-    
-    if (oSymTable -> length > oSymTable -> totalNumBuckets) {
-      SymTable_expand (oSymTable);
-    } 
-    
-    return 1;
+    return SymTable_resize (oSymTable, bucketCount, 1);
+}
+
+/* Halves the bucket count of oSymTable, as many times as needed, once removals have left it below its shrink threshold.
+If the smaller array cannot be allocated the table simply keeps its current one. */
+static void SymTable_shrink(SymTable_T oSymTable) {
+    size_t newBucketCount = oSymTable -> totalNumBuckets / 2;
+    while (oSymTable -> length < SymTable_shrinkThreshold (newBucketCount)) {
+        newBucketCount /= 2;
     }
+    (void) SymTable_resize (oSymTable, newBucketCount, SYMTABLE_REHASH_STEP == 0);
+}
+
+/* Shrinks oSymTable to the smallest size that holds its current bindings, returning to small mode if there are few
+enough of them, and finishes any pending rehash. If the smaller array cannot be allocated the table is left as it is. */
+void SymTable_compact(SymTable_T oSymTable) {
+    size_t bucketCount;
+    assert (oSymTable != NULL);
+
+    if (oSymTable -> length <= SMALL_TABLE_MAX) {
+        bucketCount = 1;
+    }
+    else {
+        bucketCount = SymTable_bucketCountFor (oSymTable -> length);
+    }
+    if (bucketCount < oSymTable -> totalNumBuckets) {
+        (void) SymTable_resize (oSymTable, bucketCount, 1);
+    }
+    else if (oSymTable -> oldBuckets != NULL) {
+        SymTable_rehash (oSymTable, (size_t) -1);
+    }
+}
+
+
+/* Finds the binding for pcKey, whose hash code in oSymTable is uHash and length is uLength, adding one with value pvValue
+if there is none, with a single chain walk. A new binding copies pcKey, unless iBorrowed is nonzero, in which case the
+binding points to pcKey. Sets *piAdded to 1 if the binding was added and 0 if it already existed. Returns
+the binding's node, or NULL if a new binding could not be allocated. */
+static Node *SymTable_insert(SymTable_T oSymTable, const char *pcKey, size_t uHash, size_t uLength, int iBorrowed,
+                             const void *pvValue, int *piAdded) {
+  Node *newNode;
+  Node *currBucket;
+  Node **bucket;
+
+  *piAdded = 0;
+  SymTable_rehashStep (oSymTable);
+  bucket = SymTable_bucket (oSymTable, uHash);
+  for (currBucket = *bucket; currBucket != NULL; currBucket = currBucket -> next) {
+    if (SymTable_keyEquals (currBucket, pcKey, uHash, uLength)) {
+      return currBucket;
+    }
+  }
+
+  newNode = SymTable_allocNode (oSymTable, iBorrowed ? sizeof (const char *) : uLength + 1);
+  
+  if (newNode == NULL) {
+    return NULL;
+  }
+  
+  if (iBorrowed) {
+    memcpy (newNode -> chars, (const void *) &pcKey, sizeof (pcKey));
+    newNode -> keyLength = uLength | BORROWED_BIT;
+  }
   else {
-    return 0;
+    memcpy (newNode -> chars, pcKey, uLength);
+    newNode -> chars [uLength] = '\0';
+    newNode -> keyLength = uLength;
   }
+  newNode -> value = (void *) pvValue;
+  newNode -> hash = uHash;
+  newNode -> next = *bucket;
+  *bucket = newNode;
+  oSymTable -> length++;
+  *piAdded = 1;
+  
+  if (oSymTable -> length > oSymTable -> expandThreshold) {
+    SymTable_expand (oSymTable);
+  } 
+  
+  return newNode;
+}
+
+/* Returns 1 if a new binding with key pcKey and value pvValue was successfully added to oSymTable, returns 0 if it was unsuccessful. */
+int SymTable_put(SymTable_T oSymTable, const char *pcKey, const void *pvValue) {
+  size_t uHash;
+  size_t uLength;
+  int iAdded;
+  assert (oSymTable != NULL);
+  assert (pcKey != NULL);
+  
+  uHash = SymTable_hash (oSymTable, pcKey, &uLength);
+  (void) SymTable_insert (oSymTable, pcKey, uHash, uLength, 0, pvValue, &iAdded);
+  return iAdded;
+}
+
+/* Adds a binding of pcKey to pvValue in oSymTable, as SymTable_put does, but points to pcKey instead of copying it.
+Returns 1 if successful, or 0 if pcKey was already bound or there is insufficient memory. */
+int SymTable_putBorrowed(SymTable_T oSymTable, const char *pcKey, const void *pvValue) {
+  size_t uHash;
+  size_t uLength;
+  int iAdded;
+  assert (oSymTable != NULL);
+  assert (pcKey != NULL);
+
+  uHash = SymTable_hash (oSymTable, pcKey, &uLength);
+  (void) SymTable_insert (oSymTable, pcKey, uHash, uLength, 1, pvValue, &iAdded);
+  return iAdded;
+}
+
+/* Returns a pointer to the value bound to pcKey in oSymTable, first adding a binding of pcKey to pvValue if there is none,
+or NULL if there is insufficient memory. */
+void **SymTable_getOrPut(SymTable_T oSymTable, const char *pcKey, const void *pvValue) {
+  Node *node;
+  size_t uHash;
+  size_t uLength;
+  int iAdded;
+  assert (oSymTable != NULL);
+  assert (pcKey != NULL);
+
+  uHash = SymTable_hash (oSymTable, pcKey, &uLength);
+  node = SymTable_insert (oSymTable, pcKey, uHash, uLength, 0, pvValue, &iAdded);
+  if (node == NULL) {
+    return NULL;
+  }
+  return &node -> value;
 }
 
 /* Replaces the value bound to pcKey with pvValue in oSymTable. */
 void *SymTable_replace(SymTable_T oSymTable, const char *pcKey, const void *pvValue) {
   Node *currBucket;
   void *ogValue;
-  size_t hashIndex;
+  size_t uHash;
+  size_t uLength;
   assert (oSymTable != NULL);
   assert (pcKey != NULL);
   
-  hashIndex = SymTable_hash (pcKey, oSymTable -> totalNumBuckets);
-  currBucket = oSymTable -> buckets [hashIndex];
+  uHash = SymTable_hash (oSymTable, pcKey, &uLength);
+  SymTable_rehashStep (oSymTable);
+  currBucket = *SymTable_bucket (oSymTable, uHash);
 
   while (currBucket != NULL) {
-    if (strcmp (currBucket -> key, pcKey) == 0) {
+    if (SymTable_keyEquals (currBucket, pcKey, uHash, uLength)) {
       ogValue = currBucket -> value;
       currBucket -> value = (void *) pvValue;
       return ogValue;
@@ -194,67 +803,267 @@ void *SymTable_replace(SymTable_T oSymTable, const char *pcKey, const void *pvVa
   return NULL;
 }
 
-/* Returns 1 if oSymTable has a binding for pcKey, returns 0 if it doesn't */
-int SymTable_contains(SymTable_T oSymTable, const char *pcKey) {
+/* Returns the node of oSymTable holding pcKey, whose hash code in oSymTable is uHash and length is uLength, or NULL if
+there is none. */
+static Node *SymTable_lookup(SymTable_T oSymTable, const char *pcKey, size_t uHash, size_t uLength) {
   Node *currBucket;
-  size_t hashIndex;
-  assert (oSymTable != NULL);
-  assert (pcKey != NULL);
-  
-  hashIndex = SymTable_hash(pcKey, oSymTable -> totalNumBuckets);
-  currBucket = oSymTable -> buckets [hashIndex];
+
+  SymTable_rehashStep (oSymTable);
+  currBucket = *SymTable_bucket (oSymTable, uHash);
   while (currBucket != NULL) {
-    if (strcmp (currBucket -> key, pcKey) == 0) {
-      return 1;
+    if (SymTable_keyEquals (currBucket, pcKey, uHash, uLength)) {
+      return currBucket;
     }
     currBucket = currBucket -> next;
   }
-  return 0;
+  return NULL;
+}
+
+/* Returns 1 if oSymTable has a binding for pcKey, returns 0 if it doesn't */
+int SymTable_contains(SymTable_T oSymTable, const char *pcKey) {
+  size_t uHash;
+  size_t uLength;
+  assert (oSymTable != NULL);
+  assert (pcKey != NULL);
+  
+  uHash = SymTable_hash (oSymTable, pcKey, &uLength);
+  return SymTable_lookup (oSymTable, pcKey, uHash, uLength) != NULL;
 }
 
 /* Returns the value bound to pcKey or NULL if not found in oSymTable. */
 void *SymTable_get(SymTable_T oSymTable, const char *pcKey) {
-  Node *currBucket;
-  size_t hashIndex;
+  Node *node;
+  size_t uHash;
+  size_t uLength;
   assert (oSymTable != NULL);
   assert (pcKey != NULL);
 
-  hashIndex = SymTable_hash(pcKey, oSymTable -> totalNumBuckets);
-  currBucket = oSymTable -> buckets [hashIndex];
-  while (currBucket != NULL) {
-    if (strcmp (currBucket -> key, pcKey) == 0) {
-      return currBucket -> value;
+  uHash = SymTable_hash (oSymTable, pcKey, &uLength);
+  node = SymTable_lookup (oSymTable, pcKey, uHash, uLength);
+  if (node == NULL) {
+    return NULL;
+  }
+  return node -> value;
+}
+
+/* Returns the hash code of pcKey shared by every table of the process, together with its length. */
+SymTable_Hash SymTable_hashKey(const char *pcKey) {
+  SymTable_Hash oHash;
+  assert (pcKey != NULL);
+
+  oHash.uLength = strlen (pcKey);
+  oHash.uHash = (size_t) SymTableHashFn_bytes (pcKey, oHash.uLength, SymTableHashFn_secret ());
+  return oHash;
+}
+
+/* Adds a binding of pcKey, whose hash code oHash came from SymTable_hashKey, to pvValue in oSymTable, as SymTable_put
+does. Returns 1 if successful, or 0 if pcKey was already bound or there is insufficient memory. */
+int SymTable_putHashed(SymTable_T oSymTable, const char *pcKey, SymTable_Hash oHash, const void *pvValue) {
+  int iAdded;
+  assert (oSymTable != NULL);
+  assert (pcKey != NULL);
+
+  (void) SymTable_insert (oSymTable, pcKey, SymTable_tableHash (oSymTable, oHash.uHash), oHash.uLength, 0, pvValue,
+                          &iAdded);
+  return iAdded;
+}
+
+/* Returns 1 if oSymTable has a binding for pcKey, whose hash code oHash came from SymTable_hashKey, or 0 if it doesn't. */
+int SymTable_containsHashed(SymTable_T oSymTable, const char *pcKey, SymTable_Hash oHash) {
+  assert (oSymTable != NULL);
+  assert (pcKey != NULL);
+
+  return SymTable_lookup (oSymTable, pcKey, SymTable_tableHash (oSymTable, oHash.uHash), oHash.uLength) != NULL;
+}
+
+/* Returns the value bound in oSymTable to pcKey, whose hash code oHash came from SymTable_hashKey, or NULL if there is
+none. */
+void *SymTable_getHashed(SymTable_T oSymTable, const char *pcKey, SymTable_Hash oHash) {
+  Node *node;
+  assert (oSymTable != NULL);
+  assert (pcKey != NULL);
+
+  node = SymTable_lookup (oSymTable, pcKey, SymTable_tableHash (oSymTable, oHash.uHash), oHash.uLength);
+  if (node == NULL) {
+    return NULL;
+  }
+  return node -> value;
+}
+
+/* Returns the header of pcAtom, which was returned by SymTable_intern. */
+static const Atom *SymTable_atom(const char *pcAtom) {
+  return (const Atom *) (const void *) (pcAtom - offsetof (Atom, chars));
+}
+
+/* Returns the atom equal to pcKey, adding it to the intern pool if it is new, or NULL if there is insufficient memory.
+The pool is itself a table, whose bindings are atoms bound to nothing; it lives as long as the process, and its mutex
+lets any thread intern keys. */
+const char *SymTable_intern(const char *pcKey) {
+  static SymTable_T oPool = NULL;
+  static pthread_mutex_t oPoolMutex = PTHREAD_MUTEX_INITIALIZER;
+  SymTable_Hash oHash;
+  const char *pcAtom = NULL;
+  Atom *atom;
+  Node *node;
+  size_t uHash;
+  int iAdded;
+  assert (pcKey != NULL);
+
+  oHash = SymTable_hashKey (pcKey);
+  pthread_mutex_lock (&oPoolMutex);
+  if (oPool == NULL) {
+    oPool = SymTable_new ();
+  }
+  if (oPool != NULL) {
+    uHash = SymTable_tableHash (oPool, oHash.uHash);
+    node = SymTable_lookup (oPool, pcKey, uHash, oHash.uLength);
+    if (node != NULL) {
+      pcAtom = SymTable_nodeKey (node);
+    }
+    else {
+      atom = (Atom *) malloc (offsetof (Atom, chars) + oHash.uLength + 1);
+      if (atom != NULL) {
+        atom -> oHash = oHash;
+        memcpy (atom -> chars, pcKey, oHash.uLength + 1);
+        if (SymTable_insert (oPool, atom -> chars, uHash, oHash.uLength, 1, NULL, &iAdded) != NULL) {
+          pcAtom = atom -> chars;
+        }
+        else {
+          free (atom);
+        }
+      }
     }
-    currBucket = currBucket -> next;
   }
-  return NULL;
+  pthread_mutex_unlock (&oPoolMutex);
+  return pcAtom;
 }
 
-/* Removes the value bound to pcKey, returns the removed value or NULL if not found in oSymTable. */
-void *SymTable_remove(SymTable_T oSymTable, const char *pcKey) {
+/* Adds a binding of the atom pcAtom to pvValue in oSymTable, as SymTable_put does, without copying or hashing pcAtom.
+Returns 1 if successful, or 0 if pcAtom was already bound or there is insufficient memory. */
+int SymTable_putAtom(SymTable_T oSymTable, const char *pcAtom, const void *pvValue) {
+  const Atom *atom;
+  int iAdded;
+  assert (oSymTable != NULL);
+  assert (pcAtom != NULL);
+
+  atom = SymTable_atom (pcAtom);
+  (void) SymTable_insert (oSymTable, pcAtom, SymTable_tableHash (oSymTable, atom -> oHash.uHash), atom -> oHash.uLength, 1,
+                          pvValue, &iAdded);
+  return iAdded;
+}
+
+/* Returns 1 if oSymTable has a binding for the atom pcAtom, or 0 if it doesn't. */
+int SymTable_containsAtom(SymTable_T oSymTable, const char *pcAtom) {
+  const Atom *atom;
+  assert (oSymTable != NULL);
+  assert (pcAtom != NULL);
+
+  atom = SymTable_atom (pcAtom);
+  return SymTable_lookup (oSymTable, pcAtom, SymTable_tableHash (oSymTable, atom -> oHash.uHash),
+                          atom -> oHash.uLength) != NULL;
+}
+
+/* Returns the value bound to the atom pcAtom in oSymTable, or NULL if there is none. */
+void *SymTable_getAtom(SymTable_T oSymTable, const char *pcAtom) {
+  const Atom *atom;
+  Node *node;
+  assert (oSymTable != NULL);
+  assert (pcAtom != NULL);
+
+  atom = SymTable_atom (pcAtom);
+  node = SymTable_lookup (oSymTable, pcAtom, SymTable_tableHash (oSymTable, atom -> oHash.uHash), atom -> oHash.uLength);
+  if (node == NULL) {
+    return NULL;
+  }
+  return node -> value;
+}
+
+/* Looks up the uCount keys of apcKeys in oSymTable, GETMANY_BATCH at a time, storing their values in apvValues. Each
+batch is hashed and its bucket heads prefetched first; then the chains are walked together, one node per key per round,
+with the next node of each prefetched while the others are compared. Returns the number of keys found. */
+size_t SymTable_getMany(SymTable_T oSymTable, const char * const *apcKeys, size_t uCount, void **apvValues) {
+  size_t hashes[GETMANY_BATCH];
+  size_t lengths[GETMANY_BATCH];
+  Node **heads[GETMANY_BATCH];
+  Node *nodes[GETMANY_BATCH];
+  size_t start;
+  size_t batch;
+  size_t active;
+  size_t found = 0;
+  size_t i;
+  assert (oSymTable != NULL);
+  assert (apcKeys != NULL || uCount == 0);
+  assert (apvValues != NULL || uCount == 0);
+
+  for (start = 0; start < uCount; start += batch) {
+    batch = uCount - start < GETMANY_BATCH ? uCount - start : GETMANY_BATCH;
+    /* Take the rehash steps of the whole batch first, so that no bucket moves while the batch is in flight. */
+    for (i = 0; i < batch; i++) {
+      SymTable_rehashStep (oSymTable);
+    }
+    for (i = 0; i < batch; i++) {
+      hashes [i] = SymTable_hash (oSymTable, apcKeys [start + i], &lengths [i]);
+      heads [i] = SymTable_bucket (oSymTable, hashes [i]);
+      SYMTABLE_PREFETCH (heads [i]);
+    }
+    for (i = 0; i < batch; i++) {
+      nodes [i] = *heads [i];
+      if (nodes [i] != NULL) {
+        SYMTABLE_PREFETCH (nodes [i]);
+      }
+      apvValues [start + i] = NULL;
+    }
+    do {
+      active = 0;
+      for (i = 0; i < batch; i++) {
+        if (nodes [i] == NULL) {
+          continue;
+        }
+        if (SymTable_keyEquals (nodes [i], apcKeys [start + i], hashes [i], lengths [i])) {
+          apvValues [start + i] = nodes [i] -> value;
+          nodes [i] = NULL;
+          found++;
+        }
+        else {
+          nodes [i] = nodes [i] -> next;
+          if (nodes [i] != NULL) {
+            SYMTABLE_PREFETCH (nodes [i]);
+            active++;
+          }
+        }
+      }
+    } while (active > 0);
+  }
+  return found;
+}
+
+/* Removes the binding for pcKey, whose hash code in oSymTable is uHash and length is uLength, and returns its value, or
+NULL if there is none. */
+static void *SymTable_delete(SymTable_T oSymTable, const char *pcKey, size_t uHash, size_t uLength) {
   Node *currBucket;
   Node *prevBucket;
   void *currValue;
-  size_t hashIndex;
-  assert (oSymTable != NULL);
-  assert (pcKey != NULL);
+  Node **bucket;
 
-  hashIndex = SymTable_hash (pcKey, oSymTable -> totalNumBuckets);  
-  currBucket = oSymTable -> buckets [hashIndex];  
+  SymTable_rehashStep (oSymTable);
+  bucket = SymTable_bucket (oSymTable, uHash);
+  currBucket = *bucket;
   prevBucket = NULL;
     
   while (currBucket != NULL) {
-    if (strcmp(currBucket -> key, pcKey) == 0) {
+    if (SymTable_keyEquals (currBucket, pcKey, uHash, uLength)) {
       if (prevBucket != NULL) {
         prevBucket -> next = currBucket -> next;
       }
       else {
-        oSymTable -> buckets [hashIndex] = currBucket -> next;
+        *bucket = currBucket -> next;
       }
       currValue = currBucket -> value;
-      free(currBucket -> key);
-      free(currBucket);
+      SymTable_freeNode (oSymTable, currBucket);
       oSymTable -> length--;
+      if (oSymTable -> length < oSymTable -> shrinkThreshold) {
+        SymTable_shrink (oSymTable);
+      }
       return currValue;
     }
     prevBucket = currBucket;
@@ -263,6 +1072,157 @@ void *SymTable_remove(SymTable_T oSymTable, const char *pcKey) {
 return NULL;   
 }
 
+/* Removes the value bound to pcKey, returns the removed value or NULL if not found in oSymTable. */
+void *SymTable_remove(SymTable_T oSymTable, const char *pcKey) {
+  size_t uHash;
+  size_t uLength;
+  assert (oSymTable != NULL);
+  assert (pcKey != NULL);
+
+  uHash = SymTable_hash (oSymTable, pcKey, &uLength);
+  return SymTable_delete (oSymTable, pcKey, uHash, uLength);
+}
+
+/* Replaces the value bound to pcKey, whose process-wide hash code and length are oHash, with pvValue in oSymTable and
+returns the old value, or NULL if pcKey is not bound. */
+void *SymTable_replaceHashed(SymTable_T oSymTable, const char *pcKey, SymTable_Hash oHash, const void *pvValue) {
+  Node *node;
+  void *ogValue;
+  assert (oSymTable != NULL);
+  assert (pcKey != NULL);
+
+  node = SymTable_lookup (oSymTable, pcKey, SymTable_tableHash (oSymTable, oHash.uHash), oHash.uLength);
+  if (node == NULL) {
+    return NULL;
+  }
+  ogValue = node -> value;
+  node -> value = (void *) pvValue;
+  return ogValue;
+}
+
+/* Removes the binding for pcKey, whose process-wide hash code and length are oHash, and returns its value, or NULL if
+there is none. */
+void *SymTable_removeHashed(SymTable_T oSymTable, const char *pcKey, SymTable_Hash oHash) {
+  assert (oSymTable != NULL);
+  assert (pcKey != NULL);
+
+  return SymTable_delete (oSymTable, pcKey, SymTable_tableHash (oSymTable, oHash.uHash), oHash.uLength);
+}
+
+/* Adds a binding of the key made of the uLength bytes at pvKey to pvValue in oSymTable, as SymTable_put does. Returns 1
+if successful, or 0 if the key was already bound or there is insufficient memory. */
+int SymTable_putN(SymTable_T oSymTable, const void *pvKey, size_t uLength, const void *pvValue) {
+  int iAdded;
+  assert (oSymTable != NULL);
+  assert (pvKey != NULL);
+
+  (void) SymTable_insert (oSymTable, (const char *) pvKey, SymTable_hashN (oSymTable, pvKey, uLength), uLength, 0,
+                          pvValue, &iAdded);
+  return iAdded;
+}
+
+/* Returns 1 if oSymTable has a binding for the key made of the uLength bytes at pvKey, or 0 if it doesn't. */
+int SymTable_containsN(SymTable_T oSymTable, const void *pvKey, size_t uLength) {
+  assert (oSymTable != NULL);
+  assert (pvKey != NULL);
+
+  return SymTable_lookup (oSymTable, (const char *) pvKey, SymTable_hashN (oSymTable, pvKey, uLength), uLength) != NULL;
+}
+
+/* Returns the value bound to the key made of the uLength bytes at pvKey in oSymTable, or NULL if there is none. */
+void *SymTable_getN(SymTable_T oSymTable, const void *pvKey, size_t uLength) {
+  Node *node;
+  assert (oSymTable != NULL);
+  assert (pvKey != NULL);
+
+  node = SymTable_lookup (oSymTable, (const char *) pvKey, SymTable_hashN (oSymTable, pvKey, uLength), uLength);
+  if (node == NULL) {
+    return NULL;
+  }
+  return node -> value;
+}
+
+/* Removes the binding for the key made of the uLength bytes at pvKey from oSymTable and returns its value, or NULL if
+there is none. */
+void *SymTable_removeN(SymTable_T oSymTable, const void *pvKey, size_t uLength) {
+  assert (oSymTable != NULL);
+  assert (pvKey != NULL);
+
+  return SymTable_delete (oSymTable, (const char *) pvKey, SymTable_hashN (oSymTable, pvKey, uLength), uLength);
+}
+
+/* Adds the chains of the buckets from uFirst to uEnd of aBuckets to *poStats, and the number of non-empty chains and of
+key comparisons needed to find every binding in them to *puChains and *puProbes. */
+static void SymTable_addChains(Node **aBuckets, size_t uFirst, size_t uEnd, SymTable_Stats *poStats, size_t *puChains,
+                               size_t *puProbes) {
+  Node *currNode;
+  size_t chain;
+  size_t i;
+
+  for (i = uFirst; i < uEnd; i++) {
+    chain = 0;
+    for (currNode = aBuckets [i]; currNode != NULL; currNode = currNode -> next) {
+      chain++;
+      poStats -> uNodeBytes += offsetof (Node, chars);
+      if ((currNode -> keyLength & BORROWED_BIT) == 0) {
+        poStats -> uKeyBytes += SymTable_nodeChars (currNode);
+      }
+      else {
+        poStats -> uNodeBytes += SymTable_nodeChars (currNode);
+      }
+    }
+    poStats -> auChainHistogram [chain < SYMTABLE_STATS_HISTOGRAM_SIZE ? chain : SYMTABLE_STATS_HISTOGRAM_SIZE - 1]++;
+    if (chain > poStats -> uMaxChain) {
+      poStats -> uMaxChain = chain;
+    }
+    if (chain > 0) {
+      (*puChains)++;
+    }
+    *puProbes += chain * (chain + 1) / 2;
+  }
+}
+
+/* Fills *poStats with the shape and memory use of oSymTable, walking both bucket arrays while an incremental rehash is in
+progress. */
+void SymTable_getStats(SymTable_T oSymTable, SymTable_Stats *poStats) {
+  Slab *currSlab;
+  size_t chains = 0;
+  size_t probes = 0;
+  assert (oSymTable != NULL);
+  assert (poStats != NULL);
+
+  memset (poStats, 0, sizeof (SymTable_Stats));
+  poStats -> uLength = oSymTable -> length;
+  poStats -> uBucketCount = oSymTable -> totalNumBuckets;
+  poStats -> dLoadFactor = (double) oSymTable -> length / (double) oSymTable -> totalNumBuckets;
+  poStats -> uExpansions = oSymTable -> expansions;
+  SymTable_addChains (oSymTable -> buckets, 0, oSymTable -> totalNumBuckets, poStats, &chains, &probes);
+  if (oSymTable -> oldBuckets != NULL) {
+    SymTable_addChains (oSymTable -> oldBuckets, oSymTable -> rehashIndex, oSymTable -> oldNumBuckets, poStats, &chains,
+                        &probes);
+  }
+  if (chains > 0) {
+    poStats -> dAvgChain = (double) oSymTable -> length / (double) chains;
+    poStats -> dAvgProbe = (double) probes / (double) oSymTable -> length;
+  }
+
+  poStats -> uTableBytes = sizeof (struct SymTable);
+  if (oSymTable -> buckets != &oSymTable -> smallBucket) {
+    poStats -> uBucketBytes += oSymTable -> totalNumBuckets * sizeof (Node *);
+  }
+  if (oSymTable -> oldBuckets != NULL && oSymTable -> oldBuckets != &oSymTable -> smallBucket) {
+    poStats -> uBucketBytes += oSymTable -> oldNumBuckets * sizeof (Node *);
+  }
+  if (oSymTable -> arena != NULL) {
+    poStats -> uTableBytes += sizeof (Arena);
+    poStats -> uNodeBytes = 0;
+    for (currSlab = oSymTable -> arena -> slabs; currSlab != NULL; currSlab = currSlab -> next) {
+      poStats -> uNodeBytes += currSlab -> size;
+    }
+    poStats -> uNodeBytes -= poStats -> uKeyBytes;
+  }
+}
+
 /* Applies the function pointed to by pfApply to each binding with key pcKey and value pvValue in the oSymTable, passing an additional 
 user-specified argument pvExtra. */
 void SymTable_map(SymTable_T oSymTable, void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra), const void *pvExtra) {
@@ -274,8 +1234,233 @@ void SymTable_map(SymTable_T oSymTable, void (*pfApply)(const char *pcKey, void
   for (i = 0; i < oSymTable -> totalNumBuckets; i++) {
     currBucket = oSymTable -> buckets [i];
     while (currBucket) {
-      (*pfApply) (currBucket -> key, currBucket -> value, (void *) pvExtra);
+      (*pfApply) (SymTable_nodeKey (currBucket), currBucket -> value, (void *) pvExtra);
+      currBucket = currBucket -> next;
+    }
+  }
+  for (i = oSymTable -> rehashIndex; i < oSymTable -> oldNumBuckets; i++) {
+    currBucket = oSymTable -> oldBuckets [i];
+    while (currBucket) {
+      (*pfApply) (SymTable_nodeKey (currBucket), currBucket -> value, (void *) pvExtra);
       currBucket = currBucket -> next;
     }
   }
 }
+
+/* Claims the next range of buckets of pJob for the calling thread. Returns the first index of the range and sets *puEnd
+past its last one, or returns *puEnd when nothing is left. */
+static size_t SymTable_mapClaim(MapJob *pJob, size_t *puEnd) {
+  size_t start;
+  pthread_mutex_lock (&pJob -> mutex);
+  start = pJob -> next;
+  if (pJob -> oSymTable -> totalNumBuckets - start > MAP_CHUNK_BUCKETS) {
+    pJob -> next = start + MAP_CHUNK_BUCKETS;
+  }
+  else {
+    pJob -> next = pJob -> oSymTable -> totalNumBuckets;
+  }
+  *puEnd = pJob -> next;
+  pthread_mutex_unlock (&pJob -> mutex);
+  return start;
+}
+
+/* Applies the function of the MapJob pointed to by pvJob to the bindings in each range the calling thread claims, until
+none are left. Threads that finish their ranges early simply claim more, so the work evens out across threads. */
+static void *SymTable_mapWorker(void *pvJob) {
+  MapJob *pJob = (MapJob *) pvJob;
+  SymTable_T oSymTable = pJob -> oSymTable;
+  Node *currBucket;
+  size_t i;
+  size_t end;
+
+  for (i = SymTable_mapClaim (pJob, &end); i < end; i = SymTable_mapClaim (pJob, &end)) {
+    for (; i < end; i++) {
+      for (currBucket = oSymTable -> buckets [i]; currBucket != NULL; currBucket = currBucket -> next) {
+        (*pJob -> pfApply) (SymTable_nodeKey (currBucket), currBucket -> value, pJob -> pvExtra);
+      }
+    }
+  }
+  return NULL;
+}
+
+/* Applies pfApply to each binding of oSymTable with the length of its key. Like SymTable_map, it visits the buckets not
+yet moved by a pending rehash in place rather than finishing the rehash. */
+void SymTable_mapN(SymTable_T oSymTable, void (*pfApply)(const void *pvKey, size_t uLength, void *pvValue, void *pvExtra),
+                   const void *pvExtra) {
+  Node *currBucket;
+  size_t i;
+  assert (oSymTable != NULL);
+  assert (pfApply != NULL);
+
+  for (i = 0; i < oSymTable -> totalNumBuckets; i++) {
+    for (currBucket = oSymTable -> buckets [i]; currBucket != NULL; currBucket = currBucket -> next) {
+      (*pfApply) (SymTable_nodeKey (currBucket), currBucket -> keyLength & ~BORROWED_BIT, currBucket -> value,
+                  (void *) pvExtra);
+    }
+  }
+  for (i = oSymTable -> rehashIndex; i < oSymTable -> oldNumBuckets; i++) {
+    for (currBucket = oSymTable -> oldBuckets [i]; currBucket != NULL; currBucket = currBucket -> next) {
+      (*pfApply) (SymTable_nodeKey (currBucket), currBucket -> keyLength & ~BORROWED_BIT, currBucket -> value,
+                  (void *) pvExtra);
+    }
+  }
+}
+
+/* Applies pfApply to each binding of oSymTable on up to uThreadCount threads. Any pending rehash is finished first, so
+the threads share out one bucket array. The calling thread works too, and if some threads cannot be started the others
+do their share. */
+void SymTable_mapParallel(SymTable_T oSymTable, void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+                          const void *pvExtra, size_t uThreadCount) {
+  MapJob job;
+  pthread_t *threads;
+  size_t uChunkCount;
+  size_t started = 0;
+  size_t i;
+  assert (oSymTable != NULL);
+  assert (pfApply != NULL);
+
+  if (oSymTable -> oldBuckets != NULL) {
+    SymTable_rehash (oSymTable, (size_t) -1);
+  }
+  if (uThreadCount <= 1 || oSymTable -> totalNumBuckets <= MAP_CHUNK_BUCKETS) {
+    SymTable_map (oSymTable, pfApply, pvExtra);
+    return;
+  }
+  /* A thread beyond one per chunk of buckets would find nothing to claim. The cap also keeps the size of the
+  array of threads from overflowing. */
+  uChunkCount = (oSymTable -> totalNumBuckets + MAP_CHUNK_BUCKETS - 1) / MAP_CHUNK_BUCKETS;
+  if (uThreadCount > uChunkCount) {
+    uThreadCount = uChunkCount;
+  }
+
+  job.oSymTable = oSymTable;
+  job.pfApply = pfApply;
+  job.pvExtra = (void *) pvExtra;
+  job.next = 0;
+  if (pthread_mutex_init (&job.mutex, NULL) != 0) {
+    SymTable_map (oSymTable, pfApply, pvExtra);
+    return;
+  }
+  threads = (pthread_t *) malloc ((uThreadCount - 1) * sizeof (pthread_t));
+  if (threads != NULL) {
+    for (i = 0; i < uThreadCount - 1; i++) {
+      if (pthread_create (&threads [started], NULL, SymTable_mapWorker, &job) == 0) {
+        started++;
+      }
+    }
+  }
+  (void) SymTable_mapWorker (&job);
+  for (i = 0; i < started; i++) {
+    pthread_join (threads [i], NULL);
+  }
+  free (threads);
+  pthread_mutex_destroy (&job.mutex);
+}
+
+/* Removes every binding of oSymTable for which pfPred returns nonzero, unlinking each one as the sweep reaches it, and
+returns the number removed. pfOnRemoved, if not NULL, sees each binding just before it goes. */
+size_t SymTable_removeIf(SymTable_T oSymTable, int (*pfPred)(const char *pcKey, void *pvValue, void *pvExtra),
+                         const void *pvExtra, void (*pfOnRemoved)(const char *pcKey, void *pvValue, void *pvExtra)) {
+  SymTable_Iter oIter;
+  size_t uRemoved = 0;
+  assert (oSymTable != NULL);
+  assert (pfPred != NULL);
+
+  for (SymTable_iterBegin (oSymTable, &oIter); SymTable_iterNext (&oIter); ) {
+    if ((*pfPred) (SymTable_iterKey (&oIter), SymTable_iterValue (&oIter), (void *) pvExtra)) {
+      if (pfOnRemoved != NULL) {
+        (*pfOnRemoved) (SymTable_iterKey (&oIter), SymTable_iterValue (&oIter), (void *) pvExtra);
+      }
+      (void) SymTable_iterRemoveCurrent (&oIter);
+      uRemoved++;
+    }
+  }
+  return uRemoved;
+}
+
+/* Sets up poIter to traverse the bindings of oSymTable, first finishing any pending rehash so that there is only one
+bucket array to walk. */
+void SymTable_iterBegin(SymTable_T oSymTable, SymTable_Iter *poIter) {
+  assert (oSymTable != NULL);
+  assert (poIter != NULL);
+
+  if (oSymTable -> oldBuckets != NULL) {
+    SymTable_rehash (oSymTable, (size_t) -1);
+  }
+  poIter -> oSymTable = oSymTable;
+  poIter -> uIndex = 0;
+  poIter -> pvLink = &oSymTable -> buckets [0];
+  poIter -> pvCurrent = NULL;
+  poIter -> iRemoved = 0;
+}
+
+/* Moves poIter to the next binding of its table, walking the current chain and then the following buckets. Returns 1
+if there is one, or 0 at the end, where a shrink put off by SymTable_iterRemoveCurrent happens if the traversal removed
+any binding. */
+int SymTable_iterNext(SymTable_Iter *poIter) {
+  SymTable_T oSymTable;
+  Node **link;
+  assert (poIter != NULL);
+
+  if (poIter -> pvLink == NULL) {
+    return 0;
+  }
+  oSymTable = poIter -> oSymTable;
+  link = (Node **) poIter -> pvLink;
+  if (poIter -> pvCurrent != NULL) {
+    link = &((Node *) poIter -> pvCurrent) -> next;
+  }
+  while (*link == NULL) {
+    if (poIter -> uIndex + 1 >= oSymTable -> totalNumBuckets) {
+      poIter -> pvLink = NULL;
+      poIter -> pvCurrent = NULL;
+      if (poIter -> iRemoved && oSymTable -> length < oSymTable -> shrinkThreshold) {
+        SymTable_shrink (oSymTable);
+      }
+      return 0;
+    }
+    poIter -> uIndex++;
+    link = &oSymTable -> buckets [poIter -> uIndex];
+  }
+  poIter -> pvLink = link;
+  poIter -> pvCurrent = *link;
+  return 1;
+}
+
+/* Returns the key of the current binding of poIter. */
+const char *SymTable_iterKey(const SymTable_Iter *poIter) {
+  assert (poIter != NULL);
+  assert (poIter -> pvCurrent != NULL);
+  return SymTable_nodeKey ((Node *) poIter -> pvCurrent);
+}
+
+/* Returns the length of the key of the current binding of poIter, as stored with the key. */
+size_t SymTable_iterKeyLength(const SymTable_Iter *poIter) {
+  assert (poIter != NULL);
+  assert (poIter -> pvCurrent != NULL);
+  return ((Node *) poIter -> pvCurrent) -> keyLength & ~BORROWED_BIT;
+}
+
+/* Returns the value of the current binding of poIter. */
+void *SymTable_iterValue(const SymTable_Iter *poIter) {
+  assert (poIter != NULL);
+  assert (poIter -> pvCurrent != NULL);
+  return ((Node *) poIter -> pvCurrent) -> value;
+}
+
+/* Unlinks the current binding of poIter through the link that points at it, frees it and returns its value. */
+void *SymTable_iterRemoveCurrent(SymTable_Iter *poIter) {
+  Node *currNode;
+  void *currValue;
+  assert (poIter != NULL);
+  assert (poIter -> pvCurrent != NULL);
+
+  currNode = (Node *) poIter -> pvCurrent;
+  *(Node **) poIter -> pvLink = currNode -> next;
+  currValue = currNode -> value;
+  SymTable_freeNode (poIter -> oSymTable, currNode);
+  poIter -> oSymTable -> length--;
+  poIter -> pvCurrent = NULL;
+  poIter -> iRemoved = 1;
+  return currValue;
+}
@@ -0,0 +1,48 @@
+/* SymTable Hash Function Implementation:
+This file holds the state behind the hash functions of symtablehashfn.h: the secret of the process, drawn once, and the
+counter that makes every table seed different. Keeping them here rather than in the header gives the whole process one
+copy of each, so that hash codes from SymTable_hashKey mean the same thing to every file that uses them. */
+
+#include "symtablehashfn.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+/* The secret of the process, the same for all of its tables, drawn once by SymTableHashFn_initSecret. */
+static uint64_t uProcessSecret = 0;
+/* Makes sure SymTableHashFn_initSecret runs once, even when the first tables are created by several threads at once. */
+static pthread_once_t oSecretOnce = PTHREAD_ONCE_INIT;
+/* The number of seeds handed out by SymTableHashFn_newSeed, only ever changed atomically. */
+static uint64_t uSeedCounter = 0;
+
+/* Draws the secret from /dev/urandom, falling back to the clock if it cannot be read. */
+static void SymTableHashFn_initSecret(void)
+{
+   FILE *psFile;
+
+   psFile = fopen("/dev/urandom", "rb");
+   if (psFile == NULL || fread(&uProcessSecret, sizeof(uProcessSecret), 1, psFile) != 1)
+      uProcessSecret = (uint64_t) time(NULL) ^ ((uint64_t) clock() << 32);
+   if (psFile != NULL)
+      fclose(psFile);
+}
+
+/* Returns the secret, drawing it on the first call. */
+uint64_t SymTableHashFn_secret(void)
+{
+   pthread_once(&oSecretOnce, SymTableHashFn_initSecret);
+   return uProcessSecret;
+}
+
+/* Returns a random seed for the table at pvTable, mixing the secret with the table's address and a call counter. The
+counter is bumped with an atomic add rather than under a lock, so that threads creating many small tables at once do
+not wait for each other. */
+uint64_t SymTableHashFn_newSeed(const void *pvTable)
+{
+   uint64_t uCounter;
+
+   uCounter = __atomic_add_fetch(&uSeedCounter, 1, __ATOMIC_RELAXED);
+   return SymTableHashFn_mix(SymTableHashFn_secret() ^ (uint64_t) (uintptr_t) pvTable,
+                             0x9e3779b97f4a7c15ULL * uCounter);
+}
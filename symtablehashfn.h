@@ -0,0 +1,119 @@
+/* This internal header defines the hash functions shared by the symbol table implementations: SymTableHashFn_mix and
+SymTableHashFn_multiply and the wyhash function SymTableHashFn_bytes, which are static inline so that the compiler can
+inline them and a file may leave some unused. It also declares SymTableHashFn_secret, which draws a secret once per
+process, and SymTableHashFn_newSeed, which gives each table its own seed. Those two keep state that every file must
+share, so they are defined in symtablehashfn.c, which is linked with any implementation that includes this header. It is
+not part of any public interface. */
+#ifndef SYMTABLEHASHFN_H
+#define SYMTABLEHASHFN_H
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/* Sets *puA and *puB to the low and high halves of the 128-bit product of *puA and *puB. */
+static inline void SymTableHashFn_multiply(uint64_t *puA, uint64_t *puB)
+{
+#if defined(__SIZEOF_INT128__)
+   __extension__ typedef unsigned __int128 Uint128;
+   Uint128 uProduct = (Uint128) *puA * *puB;
+   *puA = (uint64_t) uProduct;
+   *puB = (uint64_t) (uProduct >> 64);
+#else
+   uint64_t uALo = *puA & 0xffffffffULL, uAHi = *puA >> 32;
+   uint64_t uBLo = *puB & 0xffffffffULL, uBHi = *puB >> 32;
+   uint64_t uLoLo = uALo * uBLo, uHiLo = uAHi * uBLo;
+   uint64_t uLoHi = uALo * uBHi, uHiHi = uAHi * uBHi;
+   uint64_t uCross = (uLoLo >> 32) + (uHiLo & 0xffffffffULL) + uLoHi;
+   *puA = (uCross << 32) | (uLoLo & 0xffffffffULL);
+   *puB = (uHiLo >> 32) + (uCross >> 32) + uHiHi;
+#endif
+}
+
+/* Returns the 128-bit product of uA and uB folded to 64 bits by xoring its two halves. */
+static inline uint64_t SymTableHashFn_mix(uint64_t uA, uint64_t uB)
+{
+   SymTableHashFn_multiply(&uA, &uB);
+   return uA ^ uB;
+}
+
+/* Returns the 8 bytes at pc as a 64-bit word. */
+static inline uint64_t SymTableHashFn_read8(const unsigned char *pc)
+{
+   uint64_t uWord;
+   memcpy(&uWord, pc, sizeof(uWord));
+   return uWord;
+}
+
+/* Returns the 4 bytes at pc as a 64-bit word. */
+static inline uint64_t SymTableHashFn_read4(const unsigned char *pc)
+{
+   uint32_t uWord;
+   memcpy(&uWord, pc, sizeof(uWord));
+   return uWord;
+}
+
+/* Return a hash code for the uLength bytes at pvKey, keyed by uSeed. This is the wyhash algorithm: keys are consumed
+8 bytes (and, past 48 bytes, three independent 16-byte lanes) per step, and each step is one 64x64-bit multiply. */
+static inline uint64_t SymTableHashFn_bytes(const void *pvKey, size_t uLength, uint64_t uSeed)
+{
+   static const uint64_t SECRET[4] = {0x2d358dccaa6c78a5ULL, 0x8bb84b93962eacc9ULL,
+      0x4b33a62ed433d4a3ULL, 0x4d5a2da51de1aa47ULL};
+   const unsigned char *pc = (const unsigned char *) pvKey;
+   size_t u = uLength;
+   uint64_t uA;
+   uint64_t uB;
+   uint64_t uSeed1;
+   uint64_t uSeed2;
+
+   uSeed ^= SymTableHashFn_mix(uSeed ^ SECRET[0], SECRET[1]);
+   if (uLength <= 16) {
+      if (uLength >= 4) {
+         uA = (SymTableHashFn_read4(pc) << 32) | SymTableHashFn_read4(pc + ((uLength >> 3) << 2));
+         uB = (SymTableHashFn_read4(pc + uLength - 4) << 32)
+            | SymTableHashFn_read4(pc + uLength - 4 - ((uLength >> 3) << 2));
+      }
+      else if (uLength > 0) {
+         uA = ((uint64_t) pc[0] << 16) | ((uint64_t) pc[uLength >> 1] << 8) | pc[uLength - 1];
+         uB = 0;
+      }
+      else {
+         uA = 0;
+         uB = 0;
+      }
+   }
+   else {
+      if (u > 48) {
+         uSeed1 = uSeed;
+         uSeed2 = uSeed;
+         do {
+            uSeed = SymTableHashFn_mix(SymTableHashFn_read8(pc) ^ SECRET[1], SymTableHashFn_read8(pc + 8) ^ uSeed);
+            uSeed1 = SymTableHashFn_mix(SymTableHashFn_read8(pc + 16) ^ SECRET[2], SymTableHashFn_read8(pc + 24) ^ uSeed1);
+            uSeed2 = SymTableHashFn_mix(SymTableHashFn_read8(pc + 32) ^ SECRET[3], SymTableHashFn_read8(pc + 40) ^ uSeed2);
+            pc += 48;
+            u -= 48;
+         } while (u > 48);
+         uSeed ^= uSeed1 ^ uSeed2;
+      }
+      while (u > 16) {
+         uSeed = SymTableHashFn_mix(SymTableHashFn_read8(pc) ^ SECRET[1], SymTableHashFn_read8(pc + 8) ^ uSeed);
+         pc += 16;
+         u -= 16;
+      }
+      uA = SymTableHashFn_read8(pc + u - 16);
+      uB = SymTableHashFn_read8(pc + u - 8);
+   }
+   uA ^= SECRET[1];
+   uB ^= uSeed;
+   SymTableHashFn_multiply(&uA, &uB);
+   return SymTableHashFn_mix(uA ^ SECRET[0] ^ uLength, uB ^ SECRET[1]);
+}
+
+/* Returns the secret of the process, the same for every table and every file, drawing it on the first call. Defined in
+symtablehashfn.c. */
+uint64_t SymTableHashFn_secret(void);
+
+/* Returns a random seed for the table at pvTable. Safe to call from several threads at once. Defined in
+symtablehashfn.c. */
+uint64_t SymTableHashFn_newSeed(const void *pvTable);
+
+#endif
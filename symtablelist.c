@@ -4,39 +4,145 @@ This file implements a symbol table of string keys and void pointer values using
 
 #include "symtable.h"
 #include <assert.h>
+#include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
 
-/* Defines a linked list node that stores a key-value pair. */
+/* The bit of Node keyLength that marks a borrowed key. No key is long enough to need it. */
+#define BORROWED_BIT (~(size_t) 0 - (~(size_t) 0 >> 1))
+
+/* Defines a linked list node that stores a key-value pair. The node and its key are one allocation, unless the key is
+borrowed. */
 typedef struct Node {
-  /* The key of this binding, stored as a dynamically allocated array of characters. */
-  char *key; 
-  /* The value of this binding, stored as a generic pointer. */
-  void *value; 
   /* Pointer to the next node in the linked list. */
   struct Node *next; 
+  /* The value of this binding, stored as a generic pointer. */
+  void *value; 
+  /* The length of the key, not counting its terminating null character, with BORROWED_BIT set if the key is borrowed:
+  an atom from SymTable_intern or a key passed to SymTable_putBorrowed, which the table points to rather than copies. */
+  size_t keyLength;
+  /* The characters of the key when the table copied it, stored inline after the other fields, or else the pointer to
+  the borrowed key. SymTable_nodeKey reads either. */
+  char chars[];
 /* End of Node struct definition. */
 } Node;
 
+/* Defines an interned key. SymTable_intern hands out pointers to chars, so the header sits just before every atom. */
+typedef struct Atom {
+  /* The length of the key, in the form SymTable_hashKey returns it. */
+  SymTable_Hash oHash;
+  /* The characters of the key. */
+  char chars[];
+/* End of Atom struct definition. */
+} Atom;
+
 /* Defines a symbol table structure. */
 struct SymTable {
   /* Pointer to the first node in the linked list. */
   struct Node *first; 
   /* The total number of key-value bindings in the symbol table. */
   size_t length; 
+  /* The allocator of all of this table's memory, including the table itself. */
+  SymTable_Allocator allocator;
 };
 
-/* Creates a new symbol table and returns a pointer to it */
-SymTable_T SymTable_new(void) {
-  SymTable_T symTable = (SymTable_T) malloc (sizeof (struct SymTable));
+/* Returns a block of uSize bytes from malloc. pvContext is unused. */
+static void *SymTable_mallocBlock(size_t uSize, void *pvContext) {
+  (void) pvContext;
+  return malloc (uSize);
+}
+
+/* Gives pvBlock back to free. uSize and pvContext are unused. */
+static void SymTable_freeBlock(void *pvBlock, size_t uSize, void *pvContext) {
+  (void) uSize;
+  (void) pvContext;
+  free (pvBlock);
+}
+
+/* The allocator of the tables that are not given one. */
+static const SymTable_Allocator oDefaultAllocator = {SymTable_mallocBlock, SymTable_freeBlock, NULL};
+
+/* Returns a block of uSize bytes from the allocator of oSymTable, or NULL if there is insufficient memory. */
+static void *SymTable_alloc(SymTable_T oSymTable, size_t uSize) {
+  return (*oSymTable -> allocator.pfAlloc) (uSize, oSymTable -> allocator.pvContext);
+}
+
+/* Gives pvBlock, a block of uSize bytes, back to the allocator of oSymTable. */
+static void SymTable_release(SymTable_T oSymTable, void *pvBlock, size_t uSize) {
+  (*oSymTable -> allocator.pfFree) (pvBlock, uSize, oSymTable -> allocator.pvContext);
+}
+
+/* Returns the key of node, which is either stored inline or borrowed. */
+static const char *SymTable_nodeKey(const Node *node) {
+  const char *pcKey;
+  if ((node -> keyLength & BORROWED_BIT) == 0) {
+    return node -> chars;
+  }
+  memcpy ((void *) &pcKey, node -> chars, sizeof (pcKey));
+  return pcKey;
+}
+
+/* Returns the number of bytes stored inline in node: its key and null character, or the pointer to a borrowed key. */
+static size_t SymTable_nodeChars(const Node *node) {
+  return (node -> keyLength & BORROWED_BIT) == 0 ? node -> keyLength + 1 : sizeof (const char *);
+}
+
+/* Frees node, a node of oSymTable, together with its key unless the key is borrowed. */
+static void SymTable_freeNode(SymTable_T oSymTable, Node *node) {
+  SymTable_release (oSymTable, node, offsetof (Node, chars) + SymTable_nodeChars (node));
+}
+
+/* Returns 1 if node holds the key pcKey of length uLength, or 0 if it doesn't. Most nodes are rejected by the length
+check without touching the key bytes, and a node holding the borrowed key pcKey, such as an atom, is recognized by its
+pointer. */
+static int SymTable_keyEquals(const Node *node, const char *pcKey, size_t uLength) {
+  const char *pcNodeKey;
+  if (node -> keyLength == uLength) {
+    return memcmp (node -> chars, pcKey, uLength) == 0;
+  }
+  if (node -> keyLength != (uLength | BORROWED_BIT)) {
+    return 0;
+  }
+  pcNodeKey = SymTable_nodeKey (node);
+  return pcNodeKey == pcKey || memcmp (pcNodeKey, pcKey, uLength) == 0;
+}
+
+/* Creates a new symbol table whose memory comes from a copy of *poAllocator and returns a pointer to it */
+SymTable_T SymTable_newWithAllocator(const SymTable_Allocator *poAllocator) {
+  SymTable_T symTable;
+  assert (poAllocator != NULL);
+  assert (poAllocator -> pfAlloc != NULL);
+  assert (poAllocator -> pfFree != NULL);
+
+  symTable = (SymTable_T) (*poAllocator -> pfAlloc) (sizeof (struct SymTable), poAllocator -> pvContext);
   if (symTable == NULL) {
     return NULL;
   }
   symTable -> first = NULL;
   symTable -> length = 0;
+  symTable -> allocator = *poAllocator;
   return symTable;
 }
 
+/* Creates a new symbol table and returns a pointer to it */
+SymTable_T SymTable_new(void) {
+  return SymTable_newWithAllocator (&oDefaultAllocator);
+}
+
+/* Creates a new symbol table and returns a pointer to it. A list has nothing to size in advance, so uCapacity is
+ignored. */
+SymTable_T SymTable_newWithCapacity(size_t uCapacity) {
+  (void) uCapacity;
+  return SymTable_new ();
+}
+
+/* Creates a new symbol table and returns a pointer to it. The list implementation has no arena allocator, so this is
+the same as SymTable_new. */
+SymTable_T SymTable_newArena(void) {
+  return SymTable_new ();
+}
+
 /* Frees all the memory taken by oSymTable */
 void SymTable_free(SymTable_T oSymTable) {
   Node *currNode;
@@ -45,11 +151,10 @@ void SymTable_free(SymTable_T oSymTable) {
     currNode = oSymTable -> first;
     while (currNode != NULL) {
         nextNode = currNode -> next;
-        free (currNode->key);
-        free (currNode);
+        SymTable_freeNode (oSymTable, currNode);
         currNode = nextNode;
     }
-    free(oSymTable);
+    SymTable_release (oSymTable, oSymTable, sizeof (struct SymTable));
 }
 
 /* Returns the number of bindings in oSymTable */
@@ -58,49 +163,109 @@ size_t SymTable_getLength(SymTable_T oSymTable) {
   return (oSymTable -> length);
 }
 
-/* Returns 1 if a new binding with key pcKey and value pvValue was successfully added to oSymTable, returns 0 if it was unsuccessful */
-int SymTable_put(SymTable_T oSymTable, const char *pcKey, const void *pvValue) {
-  Node *newNode;
+/* Makes oSymTable able to hold uCapacity bindings. A list grows one node at a time, so this always succeeds. */
+int SymTable_reserve(SymTable_T oSymTable, size_t uCapacity) {
   assert (oSymTable != NULL);
-  assert (pcKey != NULL);
+  (void) uCapacity;
+  return 1;
+}
 
-  if (!SymTable_contains (oSymTable, pcKey)) {
-    newNode = (Node*) malloc (sizeof(Node));
-    
-    if (newNode == NULL)
+/* Shrinks oSymTable to fit its bindings. Every node of a list is freed as soon as its binding is removed, so there is
+nothing to give back. */
+void SymTable_compact(SymTable_T oSymTable) {
+  assert (oSymTable != NULL);
+}
+
+/* Finds the binding for pcKey, whose length is uLength, in oSymTable, adding one with value pvValue at the front of the
+list if there is none, with a single pass over the list. A new binding copies pcKey, unless iBorrowed is nonzero, in
+which case the binding points to pcKey. Sets *piAdded to 1 if the binding was added and 0 if it already
+existed. Returns the binding's node, or NULL if a new binding could not be allocated. */
+static Node *SymTable_insert(SymTable_T oSymTable, const char *pcKey, size_t uLength, int iBorrowed, const void *pvValue,
+                             int *piAdded) {
+  Node *newNode;
+  Node *currNode;
+
+  *piAdded = 0;
+  for (currNode = oSymTable -> first; currNode != NULL; currNode = currNode -> next) {
+    if (SymTable_keyEquals (currNode, pcKey, uLength))
     {
-      return 0;
-    }
-    
-    newNode -> key = malloc (strlen (pcKey) + 1);
-    
-    if (newNode -> key == NULL) {
-        free (newNode);
-        return 0;
-    }
-    
-    strcpy(newNode -> key, pcKey);
-    newNode -> value = (void *) pvValue;
-    newNode -> next = oSymTable -> first;
-    oSymTable -> first = newNode;
-    oSymTable -> length++;
-    return 1;
+      return currNode;
     }
+  }
+
+  newNode = (Node*) SymTable_alloc (oSymTable,
+                                    offsetof (Node, chars) + (iBorrowed ? sizeof (const char *) : uLength + 1));
+  
+  if (newNode == NULL)
+  {
+    return NULL;
+  }
+  
+  if (iBorrowed) {
+    memcpy (newNode -> chars, (const void *) &pcKey, sizeof (pcKey));
+    newNode -> keyLength = uLength | BORROWED_BIT;
+  }
   else {
-    return 0;
+    memcpy (newNode -> chars, pcKey, uLength);
+    newNode -> chars [uLength] = '\0';
+    newNode -> keyLength = uLength;
+  }
+  newNode -> value = (void *) pvValue;
+  newNode -> next = oSymTable -> first;
+  oSymTable -> first = newNode;
+  oSymTable -> length++;
+  *piAdded = 1;
+  return newNode;
+}
+
+/* Returns 1 if a new binding with key pcKey and value pvValue was successfully added to oSymTable, returns 0 if it was unsuccessful */
+int SymTable_put(SymTable_T oSymTable, const char *pcKey, const void *pvValue) {
+  int iAdded;
+  assert (oSymTable != NULL);
+  assert (pcKey != NULL);
+
+  (void) SymTable_insert (oSymTable, pcKey, strlen (pcKey), 0, pvValue, &iAdded);
+  return iAdded;
+}
+
+/* Adds a binding of pcKey to pvValue in oSymTable, as SymTable_put does, but points to pcKey instead of copying it.
+Returns 1 if successful, or 0 if pcKey was already bound or there is insufficient memory. */
+int SymTable_putBorrowed(SymTable_T oSymTable, const char *pcKey, const void *pvValue) {
+  int iAdded;
+  assert (oSymTable != NULL);
+  assert (pcKey != NULL);
+
+  (void) SymTable_insert (oSymTable, pcKey, strlen (pcKey), 1, pvValue, &iAdded);
+  return iAdded;
+}
+
+/* Returns a pointer to the value bound to pcKey in oSymTable, first adding a binding of pcKey to pvValue if there is none,
+or NULL if there is insufficient memory. */
+void **SymTable_getOrPut(SymTable_T oSymTable, const char *pcKey, const void *pvValue) {
+  Node *node;
+  int iAdded;
+  assert (oSymTable != NULL);
+  assert (pcKey != NULL);
+
+  node = SymTable_insert (oSymTable, pcKey, strlen (pcKey), 0, pvValue, &iAdded);
+  if (node == NULL) {
+    return NULL;
   }
+  return &node -> value;
 }
 
 /* Replaces the value bound to pcKey with pvValue in oSymTable. */
 void *SymTable_replace(SymTable_T oSymTable, const char *pcKey, const void *pvValue) {
   Node *currNode;
   void *ogValue;
+  size_t uLength;
   assert (oSymTable != NULL);
   assert (pcKey != NULL);
 
+  uLength = strlen (pcKey);
   currNode = oSymTable -> first;
   while (currNode != NULL) {
-    if (strcmp (currNode -> key, pcKey) == 0)
+    if (SymTable_keyEquals (currNode, pcKey, uLength))
     {
       ogValue = currNode -> value;
       currNode -> value = (void *)pvValue;
@@ -111,53 +276,202 @@ void *SymTable_replace(SymTable_T oSymTable, const char *pcKey, const void *pvVa
   return NULL;
 }
 
-/* Returns 1 if oSymTable has a binding for pcKey, returns 0 if it doesn't */
-int SymTable_contains(SymTable_T oSymTable, const char *pcKey) {
+/* Returns the node of oSymTable holding pcKey, whose length is uLength, or NULL if there is none. */
+static Node *SymTable_lookup(SymTable_T oSymTable, const char *pcKey, size_t uLength) {
   Node *currNode;
-  assert (oSymTable != NULL);
-  assert (pcKey != NULL);
 
   currNode = oSymTable -> first;
   while (currNode != NULL) {
-    if (strcmp (currNode -> key, pcKey) == 0)
+    if (SymTable_keyEquals (currNode, pcKey, uLength))
     {
-      return 1;
+      return currNode;
     }
     currNode = currNode -> next;
   }
-  return 0;
+  return NULL;
+}
+
+/* Returns 1 if oSymTable has a binding for pcKey, returns 0 if it doesn't */
+int SymTable_contains(SymTable_T oSymTable, const char *pcKey) {
+  assert (oSymTable != NULL);
+  assert (pcKey != NULL);
+
+  return SymTable_lookup (oSymTable, pcKey, strlen (pcKey)) != NULL;
 }
 
 /* Returns the value bound to pcKey or NULL if not found in oSymTable. */
 void *SymTable_get(SymTable_T oSymTable, const char *pcKey) {
-  Node *currNode;
+  Node *node;
   assert (oSymTable != NULL);
   assert (pcKey != NULL);
   
-  currNode = oSymTable -> first;
-  while (currNode != NULL) {
-    if (strcmp (currNode -> key, pcKey) == 0)
-    {
-      return currNode -> value;
+  node = SymTable_lookup (oSymTable, pcKey, strlen (pcKey));
+  if (node == NULL) {
+    return NULL;
+  }
+  return node -> value;
+}
+
+/* Returns the length of pcKey. A list compares keys without hashing them, so the hash code is always 0 and only the
+length is saved. */
+SymTable_Hash SymTable_hashKey(const char *pcKey) {
+  SymTable_Hash oHash;
+  assert (pcKey != NULL);
+
+  oHash.uHash = 0;
+  oHash.uLength = strlen (pcKey);
+  return oHash;
+}
+
+/* Adds a binding of pcKey, whose hash code oHash came from SymTable_hashKey, to pvValue in oSymTable, as SymTable_put
+does. Returns 1 if successful, or 0 if pcKey was already bound or there is insufficient memory. */
+int SymTable_putHashed(SymTable_T oSymTable, const char *pcKey, SymTable_Hash oHash, const void *pvValue) {
+  int iAdded;
+  assert (oSymTable != NULL);
+  assert (pcKey != NULL);
+
+  (void) SymTable_insert (oSymTable, pcKey, oHash.uLength, 0, pvValue, &iAdded);
+  return iAdded;
+}
+
+/* Returns 1 if oSymTable has a binding for pcKey, whose hash code oHash came from SymTable_hashKey, or 0 if it doesn't. */
+int SymTable_containsHashed(SymTable_T oSymTable, const char *pcKey, SymTable_Hash oHash) {
+  assert (oSymTable != NULL);
+  assert (pcKey != NULL);
+
+  return SymTable_lookup (oSymTable, pcKey, oHash.uLength) != NULL;
+}
+
+/* Returns the value bound in oSymTable to pcKey, whose hash code oHash came from SymTable_hashKey, or NULL if there is
+none. */
+void *SymTable_getHashed(SymTable_T oSymTable, const char *pcKey, SymTable_Hash oHash) {
+  Node *node;
+  assert (oSymTable != NULL);
+  assert (pcKey != NULL);
+
+  node = SymTable_lookup (oSymTable, pcKey, oHash.uLength);
+  if (node == NULL) {
+    return NULL;
+  }
+  return node -> value;
+}
+
+/* Returns the header of pcAtom, which was returned by SymTable_intern. */
+static const Atom *SymTable_atom(const char *pcAtom) {
+  return (const Atom *) (const void *) (pcAtom - offsetof (Atom, chars));
+}
+
+/* Returns the atom equal to pcKey, adding it to the intern pool if it is new, or NULL if there is insufficient memory.
+The pool is itself a table, whose bindings are atoms bound to nothing; it lives as long as the process, and its mutex
+lets any thread intern keys. Like every lookup in a list, interning takes time proportional to the number of atoms. */
+const char *SymTable_intern(const char *pcKey) {
+  static SymTable_T oPool = NULL;
+  static pthread_mutex_t oPoolMutex = PTHREAD_MUTEX_INITIALIZER;
+  const char *pcAtom = NULL;
+  Atom *atom;
+  Node *node;
+  size_t uLength;
+  int iAdded;
+  assert (pcKey != NULL);
+
+  uLength = strlen (pcKey);
+  pthread_mutex_lock (&oPoolMutex);
+  if (oPool == NULL) {
+    oPool = SymTable_new ();
+  }
+  if (oPool != NULL) {
+    node = SymTable_lookup (oPool, pcKey, uLength);
+    if (node != NULL) {
+      pcAtom = SymTable_nodeKey (node);
+    }
+    else {
+      atom = (Atom *) malloc (offsetof (Atom, chars) + uLength + 1);
+      if (atom != NULL) {
+        atom -> oHash = SymTable_hashKey (pcKey);
+        memcpy (atom -> chars, pcKey, uLength + 1);
+        if (SymTable_insert (oPool, atom -> chars, uLength, 1, NULL, &iAdded) != NULL) {
+          pcAtom = atom -> chars;
+        }
+        else {
+          free (atom);
+        }
+      }
     }
-    currNode = currNode -> next;
   }
-  return NULL;
+  pthread_mutex_unlock (&oPoolMutex);
+  return pcAtom;
 }
 
-/* Removes the value bound to pcKey, returns the removed value or NULL if not found in oSymTable. */
-void *SymTable_remove(SymTable_T oSymTable, const char *pcKey) {
+/* Adds a binding of the atom pcAtom to pvValue in oSymTable, as SymTable_put does, without copying pcAtom. Returns 1 if
+successful, or 0 if pcAtom was already bound or there is insufficient memory. */
+int SymTable_putAtom(SymTable_T oSymTable, const char *pcAtom, const void *pvValue) {
+  int iAdded;
+  assert (oSymTable != NULL);
+  assert (pcAtom != NULL);
+
+  (void) SymTable_insert (oSymTable, pcAtom, SymTable_atom (pcAtom) -> oHash.uLength, 1, pvValue, &iAdded);
+  return iAdded;
+}
+
+/* Returns 1 if oSymTable has a binding for the atom pcAtom, or 0 if it doesn't. */
+int SymTable_containsAtom(SymTable_T oSymTable, const char *pcAtom) {
+  assert (oSymTable != NULL);
+  assert (pcAtom != NULL);
+
+  return SymTable_lookup (oSymTable, pcAtom, SymTable_atom (pcAtom) -> oHash.uLength) != NULL;
+}
+
+/* Returns the value bound to the atom pcAtom in oSymTable, or NULL if there is none. */
+void *SymTable_getAtom(SymTable_T oSymTable, const char *pcAtom) {
+  Node *node;
+  assert (oSymTable != NULL);
+  assert (pcAtom != NULL);
+
+  node = SymTable_lookup (oSymTable, pcAtom, SymTable_atom (pcAtom) -> oHash.uLength);
+  if (node == NULL) {
+    return NULL;
+  }
+  return node -> value;
+}
+
+/* Looks up the uCount keys of apcKeys in oSymTable, storing their values in apvValues. A list has no buckets to
+prefetch, so the keys are looked up one by one. Returns the number of keys found. */
+size_t SymTable_getMany(SymTable_T oSymTable, const char * const *apcKeys, size_t uCount, void **apvValues) {
+  Node *currNode;
+  size_t uLength;
+  size_t found = 0;
+  size_t i;
+  assert (oSymTable != NULL);
+  assert (apcKeys != NULL || uCount == 0);
+  assert (apvValues != NULL || uCount == 0);
+
+  for (i = 0; i < uCount; i++) {
+    assert (apcKeys [i] != NULL);
+    apvValues [i] = NULL;
+    uLength = strlen (apcKeys [i]);
+    for (currNode = oSymTable -> first; currNode != NULL; currNode = currNode -> next) {
+      if (SymTable_keyEquals (currNode, apcKeys [i], uLength)) {
+        apvValues [i] = currNode -> value;
+        found++;
+        break;
+      }
+    }
+  }
+  return found;
+}
+
+/* Removes the binding for pcKey, whose length is uLength, from oSymTable and returns its value, or NULL if there is
+none. */
+static void *SymTable_delete(SymTable_T oSymTable, const char *pcKey, size_t uLength) {
   Node *currNode;
   Node *prevNode;
   void *currValue;
-  assert (oSymTable != NULL);
-  assert (pcKey != NULL);
-  
+
   currNode = oSymTable -> first;
   prevNode = NULL;
     
   while (currNode != NULL) {
-    if (strcmp(currNode -> key, pcKey) == 0) {
+    if (SymTable_keyEquals (currNode, pcKey, uLength)) {
       currValue = currNode -> value;
       
       if (prevNode != NULL) {
@@ -167,8 +481,7 @@ void *SymTable_remove(SymTable_T oSymTable, const char *pcKey) {
         oSymTable -> first = currNode -> next;
       }
       
-      free(currNode -> key);
-      free(currNode);
+      SymTable_freeNode (oSymTable, currNode);
       oSymTable -> length--;
       return currValue;
     }
@@ -178,6 +491,111 @@ void *SymTable_remove(SymTable_T oSymTable, const char *pcKey) {
 return NULL;   
 }
 
+/* Removes the value bound to pcKey, returns the removed value or NULL if not found in oSymTable. */
+void *SymTable_remove(SymTable_T oSymTable, const char *pcKey) {
+  assert (oSymTable != NULL);
+  assert (pcKey != NULL);
+
+  return SymTable_delete (oSymTable, pcKey, strlen (pcKey));
+}
+
+/* Replaces the value bound to pcKey, whose length is in oHash, with pvValue in oSymTable and returns the old value, or
+NULL if pcKey is not bound. */
+void *SymTable_replaceHashed(SymTable_T oSymTable, const char *pcKey, SymTable_Hash oHash, const void *pvValue) {
+  Node *node;
+  void *ogValue;
+  assert (oSymTable != NULL);
+  assert (pcKey != NULL);
+
+  node = SymTable_lookup (oSymTable, pcKey, oHash.uLength);
+  if (node == NULL) {
+    return NULL;
+  }
+  ogValue = node -> value;
+  node -> value = (void *) pvValue;
+  return ogValue;
+}
+
+/* Removes the binding for pcKey, whose length is in oHash, and returns its value, or NULL if there is none. */
+void *SymTable_removeHashed(SymTable_T oSymTable, const char *pcKey, SymTable_Hash oHash) {
+  assert (oSymTable != NULL);
+  assert (pcKey != NULL);
+
+  return SymTable_delete (oSymTable, pcKey, oHash.uLength);
+}
+
+/* Adds a binding of the key made of the uLength bytes at pvKey to pvValue in oSymTable, as SymTable_put does. Returns 1
+if successful, or 0 if the key was already bound or there is insufficient memory. */
+int SymTable_putN(SymTable_T oSymTable, const void *pvKey, size_t uLength, const void *pvValue) {
+  int iAdded;
+  assert (oSymTable != NULL);
+  assert (pvKey != NULL);
+
+  (void) SymTable_insert (oSymTable, (const char *) pvKey, uLength, 0, pvValue, &iAdded);
+  return iAdded;
+}
+
+/* Returns 1 if oSymTable has a binding for the key made of the uLength bytes at pvKey, or 0 if it doesn't. */
+int SymTable_containsN(SymTable_T oSymTable, const void *pvKey, size_t uLength) {
+  assert (oSymTable != NULL);
+  assert (pvKey != NULL);
+
+  return SymTable_lookup (oSymTable, (const char *) pvKey, uLength) != NULL;
+}
+
+/* Returns the value bound to the key made of the uLength bytes at pvKey in oSymTable, or NULL if there is none. */
+void *SymTable_getN(SymTable_T oSymTable, const void *pvKey, size_t uLength) {
+  Node *node;
+  assert (oSymTable != NULL);
+  assert (pvKey != NULL);
+
+  node = SymTable_lookup (oSymTable, (const char *) pvKey, uLength);
+  if (node == NULL) {
+    return NULL;
+  }
+  return node -> value;
+}
+
+/* Removes the binding for the key made of the uLength bytes at pvKey from oSymTable and returns its value, or NULL if
+there is none. */
+void *SymTable_removeN(SymTable_T oSymTable, const void *pvKey, size_t uLength) {
+  assert (oSymTable != NULL);
+  assert (pvKey != NULL);
+
+  return SymTable_delete (oSymTable, (const char *) pvKey, uLength);
+}
+
+/* Fills *poStats with the shape and memory use of oSymTable. The list is a single chain that never expands, and a
+successful lookup compares half of it on average. */
+void SymTable_getStats(SymTable_T oSymTable, SymTable_Stats *poStats) {
+  Node *currNode;
+  size_t length;
+  assert (oSymTable != NULL);
+  assert (poStats != NULL);
+
+  length = oSymTable -> length;
+  memset (poStats, 0, sizeof (SymTable_Stats));
+  poStats -> uLength = length;
+  poStats -> uBucketCount = 1;
+  poStats -> dLoadFactor = (double) length;
+  poStats -> uMaxChain = length;
+  poStats -> auChainHistogram [length < SYMTABLE_STATS_HISTOGRAM_SIZE ? length : SYMTABLE_STATS_HISTOGRAM_SIZE - 1] = 1;
+  if (length > 0) {
+    poStats -> dAvgChain = (double) length;
+    poStats -> dAvgProbe = (double) (length + 1) / 2.0;
+  }
+  poStats -> uTableBytes = sizeof (struct SymTable);
+  for (currNode = oSymTable -> first; currNode != NULL; currNode = currNode -> next) {
+    poStats -> uNodeBytes += offsetof (Node, chars);
+    if ((currNode -> keyLength & BORROWED_BIT) == 0) {
+      poStats -> uKeyBytes += SymTable_nodeChars (currNode);
+    }
+    else {
+      poStats -> uNodeBytes += SymTable_nodeChars (currNode);
+    }
+  }
+}
+
 /* Applies the function pointed to by pfApply to each binding with key pcKey and value pvValue in the oSymTable, passing an additional 
 user-specified argument pvExtra. */
 void SymTable_map(SymTable_T oSymTable, void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra), const void *pvExtra) {
@@ -186,7 +604,112 @@ void SymTable_map(SymTable_T oSymTable, void (*pfApply)(const char *pcKey, void
   assert (pfApply != NULL);
   currNode = oSymTable -> first;
   while (currNode != NULL) {
-    (*pfApply)(currNode -> key, currNode -> value, (void *) pvExtra);
+    (*pfApply)(SymTable_nodeKey (currNode), currNode -> value, (void *) pvExtra);
         currNode = currNode -> next;
   }
 }
+
+/* Applies pfApply to each binding of oSymTable with the length of its key. */
+void SymTable_mapN(SymTable_T oSymTable, void (*pfApply)(const void *pvKey, size_t uLength, void *pvValue, void *pvExtra),
+                   const void *pvExtra) {
+  Node *currNode;
+  assert (oSymTable != NULL);
+  assert (pfApply != NULL);
+
+  for (currNode = oSymTable -> first; currNode != NULL; currNode = currNode -> next) {
+    (*pfApply) (SymTable_nodeKey (currNode), currNode -> keyLength & ~BORROWED_BIT, currNode -> value, (void *) pvExtra);
+  }
+}
+
+/* Applies pfApply to each binding of oSymTable. A list cannot be split into ranges without walking it first, so this
+runs on the calling thread alone, whatever uThreadCount is. */
+void SymTable_mapParallel(SymTable_T oSymTable, void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+                          const void *pvExtra, size_t uThreadCount) {
+  (void) uThreadCount;
+  SymTable_map (oSymTable, pfApply, pvExtra);
+}
+
+/* Removes every binding of oSymTable for which pfPred returns nonzero, unlinking each one as the sweep reaches it, and
+returns the number removed. pfOnRemoved, if not NULL, sees each binding just before it goes. */
+size_t SymTable_removeIf(SymTable_T oSymTable, int (*pfPred)(const char *pcKey, void *pvValue, void *pvExtra),
+                         const void *pvExtra, void (*pfOnRemoved)(const char *pcKey, void *pvValue, void *pvExtra)) {
+  SymTable_Iter oIter;
+  size_t uRemoved = 0;
+  assert (oSymTable != NULL);
+  assert (pfPred != NULL);
+
+  for (SymTable_iterBegin (oSymTable, &oIter); SymTable_iterNext (&oIter); ) {
+    if ((*pfPred) (SymTable_iterKey (&oIter), SymTable_iterValue (&oIter), (void *) pvExtra)) {
+      if (pfOnRemoved != NULL) {
+        (*pfOnRemoved) (SymTable_iterKey (&oIter), SymTable_iterValue (&oIter), (void *) pvExtra);
+      }
+      (void) SymTable_iterRemoveCurrent (&oIter);
+      uRemoved++;
+    }
+  }
+  return uRemoved;
+}
+
+/* Sets up poIter to traverse the list of oSymTable from its first node. */
+void SymTable_iterBegin(SymTable_T oSymTable, SymTable_Iter *poIter) {
+  assert (oSymTable != NULL);
+  assert (poIter != NULL);
+
+  poIter -> oSymTable = oSymTable;
+  poIter -> uIndex = 0;
+  poIter -> pvLink = &oSymTable -> first;
+  poIter -> pvCurrent = NULL;
+  poIter -> iRemoved = 0;
+}
+
+/* Moves poIter to the next node of its list. Returns 1 if there is one, or 0 at the end. */
+int SymTable_iterNext(SymTable_Iter *poIter) {
+  Node **link;
+  assert (poIter != NULL);
+
+  link = (Node **) poIter -> pvLink;
+  if (poIter -> pvCurrent != NULL) {
+    link = &((Node *) poIter -> pvCurrent) -> next;
+  }
+  poIter -> pvLink = link;
+  poIter -> pvCurrent = *link;
+  return poIter -> pvCurrent != NULL;
+}
+
+/* Returns the key of the current binding of poIter. */
+const char *SymTable_iterKey(const SymTable_Iter *poIter) {
+  assert (poIter != NULL);
+  assert (poIter -> pvCurrent != NULL);
+  return SymTable_nodeKey ((Node *) poIter -> pvCurrent);
+}
+
+/* Returns the length of the key of the current binding of poIter, as stored with the key. */
+size_t SymTable_iterKeyLength(const SymTable_Iter *poIter) {
+  assert (poIter != NULL);
+  assert (poIter -> pvCurrent != NULL);
+  return ((Node *) poIter -> pvCurrent) -> keyLength & ~BORROWED_BIT;
+}
+
+/* Returns the value of the current binding of poIter. */
+void *SymTable_iterValue(const SymTable_Iter *poIter) {
+  assert (poIter != NULL);
+  assert (poIter -> pvCurrent != NULL);
+  return ((Node *) poIter -> pvCurrent) -> value;
+}
+
+/* Unlinks the current node of poIter through the link that points at it, frees it and returns its value. */
+void *SymTable_iterRemoveCurrent(SymTable_Iter *poIter) {
+  Node *currNode;
+  void *currValue;
+  assert (poIter != NULL);
+  assert (poIter -> pvCurrent != NULL);
+
+  currNode = (Node *) poIter -> pvCurrent;
+  *(Node **) poIter -> pvLink = currNode -> next;
+  currValue = currNode -> value;
+  SymTable_freeNode (poIter -> oSymTable, currNode);
+  poIter -> oSymTable -> length--;
+  poIter -> pvCurrent = NULL;
+  poIter -> iRemoved = 1;
+  return currValue;
+}
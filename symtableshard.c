@@ -0,0 +1,239 @@
+/* SymTable Sharded Implementation:
+This file implements a symbol table of string keys and void pointer values that many threads may use at once, as a
+front-end over SymTable_T. The table is split into a power-of-two number of shards, each an ordinary SymTable_T with
+its own lock; the top bits of a key's hash code pick its shard. A shard expands, shrinks and counts its bindings on its
+own, so a resize moves only that shard's share of the bindings and blocks only the threads that need that shard.
+
+This file uses the GCC and Clang __atomic builtins. */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "symtableshard.h"
+#include "symtable.h"
+#include <assert.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+/* The number of shards of a table whose creator did not choose one. */
+#define DEFAULT_SHARD_COUNT 16
+/* The assumed size of a cache line, used to keep the locks and lengths of neighbouring shards apart. */
+#define CACHE_LINE 64
+
+/* Defines a shard: a symbol table, the lock that guards it and a copy of its length that can be read without the lock. */
+typedef struct Shard {
+  /* Guards table. */
+  pthread_mutex_t mutex;
+  /* The bindings of this shard. */
+  SymTable_T table;
+  /* The number of bindings in table, copied from it under mutex after every put and remove. */
+  size_t length;
+/* End of Shard struct definition. */
+} Shard;
+
+/* Defines a shard padded to a whole number of cache lines. */
+typedef union PaddedShard {
+  /* The shard itself. */
+  Shard shard;
+  /* Padding. */
+  char pad[(sizeof (Shard) + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE];
+/* End of PaddedShard union definition. */
+} PaddedShard;
+
+/* Defines a sharded symbol table structure. The table is allocated on a cache line boundary and its header fills one
+cache line, so that every shard starts a cache line of its own. */
+struct SymTableShard {
+  /* The number of shards, a power of two. */
+  size_t shardCount;
+  /* The number of low bits to drop from a hash code returned by SymTable_hashKey to leave a shard index. */
+  unsigned shift;
+  /* Padding that brings shards to the next cache line. */
+  char pad[CACHE_LINE - sizeof (size_t) - sizeof (unsigned)];
+  /* The shards. */
+  PaddedShard shards[];
+};
+
+/* Returns the shard of oSymTable that holds a key whose hash code, from SymTable_hashKey, is oHash. The top bits pick
+the shard. The same hash code is then passed to the shard's table through the SymTable_*Hashed functions, which mix it
+with the table's own seed before picking a bucket, so the key is hashed once per operation. */
+static Shard *SymTableShard_shardFor(SymTableShard_T oSymTable, SymTable_Hash oHash) {
+  if (oSymTable -> shardCount == 1) {
+    return &oSymTable -> shards [0].shard;
+  }
+  return &oSymTable -> shards [oHash.uHash >> oSymTable -> shift].shard;
+}
+
+/* Creates a new sharded symbol table and returns a pointer to it */
+SymTableShard_T SymTableShard_new(size_t uShardCount) {
+  SymTableShard_T oSymTable;
+  void *pvBlock;
+  size_t shardCount = 1;
+  unsigned bits = 0;
+  size_t i;
+
+  if (uShardCount == 0) {
+    uShardCount = DEFAULT_SHARD_COUNT;
+  }
+  while (shardCount < uShardCount) {
+    if (bits == 32 || bits + 1 == sizeof (size_t) * CHAR_BIT) {
+      return NULL;
+    }
+    shardCount *= 2;
+    bits++;
+  }
+
+  assert (offsetof (struct SymTableShard, shards) % CACHE_LINE == 0);
+  if (posix_memalign (&pvBlock, CACHE_LINE, offsetof (struct SymTableShard, shards) +
+                      shardCount * sizeof (PaddedShard)) != 0) {
+    return NULL;
+  }
+  oSymTable = (SymTableShard_T) pvBlock;
+  oSymTable -> shift = (unsigned) (sizeof (size_t) * CHAR_BIT) - bits;
+  oSymTable -> shardCount = shardCount;
+  for (i = 0; i < shardCount; i++) {
+    oSymTable -> shards [i].shard.table = SymTable_new ();
+    if (oSymTable -> shards [i].shard.table == NULL) {
+      while (i > 0) {
+        i--;
+        pthread_mutex_destroy (&oSymTable -> shards [i].shard.mutex);
+        SymTable_free (oSymTable -> shards [i].shard.table);
+      }
+      free (oSymTable);
+      return NULL;
+    }
+    pthread_mutex_init (&oSymTable -> shards [i].shard.mutex, NULL);
+    oSymTable -> shards [i].shard.length = 0;
+  }
+  return oSymTable;
+}
+
+/* Frees all the memory taken by oSymTable */
+void SymTableShard_free(SymTableShard_T oSymTable) {
+  size_t i;
+  assert (oSymTable != NULL);
+
+  for (i = 0; i < oSymTable -> shardCount; i++) {
+    pthread_mutex_destroy (&oSymTable -> shards [i].shard.mutex);
+    SymTable_free (oSymTable -> shards [i].shard.table);
+  }
+  free (oSymTable);
+}
+
+/* Returns the number of bindings in oSymTable, summed over the lengths the shards publish. */
+size_t SymTableShard_getLength(SymTableShard_T oSymTable) {
+  size_t length = 0;
+  size_t i;
+  assert (oSymTable != NULL);
+
+  for (i = 0; i < oSymTable -> shardCount; i++) {
+    length += __atomic_load_n (&oSymTable -> shards [i].shard.length, __ATOMIC_RELAXED);
+  }
+  return length;
+}
+
+/* Returns the number of shards of oSymTable. */
+size_t SymTableShard_getShardCount(SymTableShard_T oSymTable) {
+  assert (oSymTable != NULL);
+  return oSymTable -> shardCount;
+}
+
+/* Returns the number of bindings in shard uShard of oSymTable, as the shard last published it. */
+size_t SymTableShard_getShardLength(SymTableShard_T oSymTable, size_t uShard) {
+  assert (oSymTable != NULL);
+  assert (uShard < oSymTable -> shardCount);
+  return __atomic_load_n (&oSymTable -> shards [uShard].shard.length, __ATOMIC_RELAXED);
+}
+
+/* Returns 1 if a new binding with key pcKey and value pvValue was successfully added to oSymTable, returns 0 if it was unsuccessful. */
+int SymTableShard_put(SymTableShard_T oSymTable, const char *pcKey, const void *pvValue) {
+  SymTable_Hash oHash;
+  Shard *shard;
+  int iSuccessful;
+  assert (oSymTable != NULL);
+
+  oHash = SymTable_hashKey (pcKey);
+  shard = SymTableShard_shardFor (oSymTable, oHash);
+  pthread_mutex_lock (&shard -> mutex);
+  iSuccessful = SymTable_putHashed (shard -> table, pcKey, oHash, pvValue);
+  __atomic_store_n (&shard -> length, SymTable_getLength (shard -> table), __ATOMIC_RELAXED);
+  pthread_mutex_unlock (&shard -> mutex);
+  return iSuccessful;
+}
+
+/* Replaces the value bound to pcKey with pvValue in oSymTable. */
+void *SymTableShard_replace(SymTableShard_T oSymTable, const char *pcKey, const void *pvValue) {
+  SymTable_Hash oHash;
+  Shard *shard;
+  void *oldValue;
+  assert (oSymTable != NULL);
+
+  oHash = SymTable_hashKey (pcKey);
+  shard = SymTableShard_shardFor (oSymTable, oHash);
+  pthread_mutex_lock (&shard -> mutex);
+  oldValue = SymTable_replaceHashed (shard -> table, pcKey, oHash, pvValue);
+  pthread_mutex_unlock (&shard -> mutex);
+  return oldValue;
+}
+
+/* Returns 1 if oSymTable has a binding for pcKey, returns 0 if it doesn't */
+int SymTableShard_contains(SymTableShard_T oSymTable, const char *pcKey) {
+  SymTable_Hash oHash;
+  Shard *shard;
+  int iFound;
+  assert (oSymTable != NULL);
+
+  oHash = SymTable_hashKey (pcKey);
+  shard = SymTableShard_shardFor (oSymTable, oHash);
+  pthread_mutex_lock (&shard -> mutex);
+  iFound = SymTable_containsHashed (shard -> table, pcKey, oHash);
+  pthread_mutex_unlock (&shard -> mutex);
+  return iFound;
+}
+
+/* Returns the value bound to pcKey or NULL if not found in oSymTable. The shard is locked even for a lookup, since
+a lookup may move buckets of a shard that is expanding incrementally. */
+void *SymTableShard_get(SymTableShard_T oSymTable, const char *pcKey) {
+  SymTable_Hash oHash;
+  Shard *shard;
+  void *value;
+  assert (oSymTable != NULL);
+
+  oHash = SymTable_hashKey (pcKey);
+  shard = SymTableShard_shardFor (oSymTable, oHash);
+  pthread_mutex_lock (&shard -> mutex);
+  value = SymTable_getHashed (shard -> table, pcKey, oHash);
+  pthread_mutex_unlock (&shard -> mutex);
+  return value;
+}
+
+/* Removes the value bound to pcKey, returns the removed value or NULL if not found in oSymTable. */
+void *SymTableShard_remove(SymTableShard_T oSymTable, const char *pcKey) {
+  SymTable_Hash oHash;
+  Shard *shard;
+  void *value;
+  assert (oSymTable != NULL);
+
+  oHash = SymTable_hashKey (pcKey);
+  shard = SymTableShard_shardFor (oSymTable, oHash);
+  pthread_mutex_lock (&shard -> mutex);
+  value = SymTable_removeHashed (shard -> table, pcKey, oHash);
+  __atomic_store_n (&shard -> length, SymTable_getLength (shard -> table), __ATOMIC_RELAXED);
+  pthread_mutex_unlock (&shard -> mutex);
+  return value;
+}
+
+/* Applies the function pointed to by pfApply to each binding with key pcKey and value pvValue in the oSymTable, passing an additional
+user-specified argument pvExtra. */
+void SymTableShard_map(SymTableShard_T oSymTable, void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+                       const void *pvExtra) {
+  size_t i;
+  assert (oSymTable != NULL);
+  assert (pfApply != NULL);
+
+  for (i = 0; i < oSymTable -> shardCount; i++) {
+    pthread_mutex_lock (&oSymTable -> shards [i].shard.mutex);
+    SymTable_map (oSymTable -> shards [i].shard.table, pfApply, pvExtra);
+    pthread_mutex_unlock (&oSymTable -> shards [i].shard.mutex);
+  }
+}
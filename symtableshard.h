@@ -0,0 +1,63 @@
+/* This header file declares the functions of a sharded symbol table that many threads may use at once:
+SymTableShard_new, SymTableShard_free, SymTableShard_getLength, SymTableShard_put, SymTableShard_replace,
+SymTableShard_contains, SymTableShard_get, SymTableShard_remove, and SymTableShard_map, which behave like their SymTable
+counterparts in symtable.h, and SymTableShard_getShardCount and SymTableShard_getShardLength, which show how the
+bindings are spread over the shards. Link symtableshard.c together with one of the SymTable implementations, and build
+with -pthread. */
+#ifndef SYMTABLESHARD_H
+#define SYMTABLESHARD_H
+#include <stddef.h>
+
+/* SymTableShard_T is a pointer to a struct representing a symbol table that stores key-value bindings, where keys are
+unique strings and values are void pointers, split into independent shards. Each shard is a SymTable_T with its own
+lock, so threads working on different shards never wait for each other, and each shard grows on its own. The lock is a
+plain mutex taken by lookups as well as changes, since a lookup in symtablehash.c may move buckets of a shard that is
+rehashing: operations on the same shard, reads included, run one at a time. The shard of a key is picked from its
+SymTable_hashKey hash code, which symtablelist.c does not compute, so with that implementation every key falls in one
+shard. */
+typedef struct SymTableShard *SymTableShard_T;
+
+/* Creates a new sharded symbol table of uShardCount shards, rounded up to a power of two, or of 16 shards if
+uShardCount is 0, and returns a pointer to it, or NULL if there is insufficient memory. No other thread may use the
+table until this returns. */
+SymTableShard_T SymTableShard_new(size_t uShardCount);
+
+/* Frees all the memory taken by oSymTable. No other thread may be using the table. */
+void SymTableShard_free(SymTableShard_T oSymTable);
+
+/* Returns the number of bindings in oSymTable, without taking any lock. While other threads are changing the table
+this is only a snapshot. */
+size_t SymTableShard_getLength(SymTableShard_T oSymTable);
+
+/* Returns the number of shards of oSymTable. */
+size_t SymTableShard_getShardCount(SymTableShard_T oSymTable);
+
+/* Returns the number of bindings in shard uShard of oSymTable, which must be less than its shard count, without taking
+any lock. Comparing the shards shows whether the keys in use spread evenly over them. */
+size_t SymTableShard_getShardLength(SymTableShard_T oSymTable, size_t uShard);
+
+/* Returns 1 if a new binding with key pcKey and value pvValue was successfully added to oSymTable, returns 0 if it was unsuccessful */
+int SymTableShard_put(SymTableShard_T oSymTable,
+  const char *pcKey, const void *pvValue);
+
+/* Replaces the value bound to pcKey with pvValue in oSymTable and returns the old value, or NULL if pcKey is not bound. */
+void *SymTableShard_replace(SymTableShard_T oSymTable,
+  const char *pcKey, const void *pvValue);
+
+/* Returns 1 if oSymTable has a binding for pcKey, returns 0 if it doesn't */
+int SymTableShard_contains(SymTableShard_T oSymTable, const char *pcKey);
+
+/* Returns the value bound to pcKey or NULL if not found in oSymTable. */
+void *SymTableShard_get(SymTableShard_T oSymTable, const char *pcKey);
+
+/* Removes the value bound to pcKey, returns the removed value or NULL if not found in oSymTable. */
+void *SymTableShard_remove(SymTableShard_T oSymTable, const char *pcKey);
+
+/* Applies the function pointed to by pfApply to each binding with key pcKey and value pvValue in oSymTable, passing an
+additional user-specified argument pvExtra. Each shard is locked while it is traversed, so pfApply must not use
+oSymTable. */
+void SymTableShard_map(SymTableShard_T oSymTable,
+  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+  const void *pvExtra);
+
+#endif
@@ -0,0 +1,1164 @@
+/* SymTable Swiss Table Implementation:
+This file implements a symbol table of string keys and void pointer values using an open-addressing hash table in the
+style of a Swiss table. Bindings live in one flat array of slots, and a parallel array of one-byte control codes records
+whether each slot is empty, deleted or full. Probing compares 16 control bytes at a time (with SSE2 when the compiler
+targets it), so most lookups touch one control group and one slot without following any pointer chain.
+*/
+
+#include "symtable.h"
+#include "symtablehashfn.h"
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/* The number of control bytes examined together by one probe step. */
+#define GROUP_WIDTH 16
+/* The initial number of slots. Always a power of two and at least GROUP_WIDTH. */
+#define INITIAL_CAPACITY 16
+/* The control byte of a slot that has never held a binding. */
+#define CTRL_EMPTY ((signed char) -128)
+/* The control byte of a slot whose binding was removed. Probes continue past it. */
+#define CTRL_DELETED ((signed char) -2)
+/* A full slot's control byte holds the low 7 bits of its key's hash code, so it is never negative. */
+#define H2_MASK 0x7F
+/* The number of slots a SymTable_mapParallel thread claims at a time: large enough that claiming is rare, small enough
+that threads which finish early keep taking work from the rest. */
+#define MAP_CHUNK_SLOTS 4096
+
+/* The number of lookups SymTable_getMany keeps in flight at once: enough to cover the latency of a cache miss with other
+work, few enough that the prefetched lines are still in the cache when they are used. */
+#define GETMANY_BATCH 16
+
+/* Starts loading the cache line at pv ahead of its use, where the compiler supports it. */
+#if defined(__GNUC__)
+#define SYMTABLE_PREFETCH(pv) __builtin_prefetch (pv)
+#else
+#define SYMTABLE_PREFETCH(pv) ((void) (pv))
+#endif
+
+/* The fraction of slots below which live bindings make the table shrink to half its capacity, though never below
+INITIAL_CAPACITY. It sits far enough under the 7/8 maximum load that a table hovering around one size does not keep
+growing and shrinking. May be overridden at compile time, e.g. -DSYMTABLE_MIN_LOAD_FACTOR=0.25 */
+#ifndef SYMTABLE_MIN_LOAD_FACTOR
+#define SYMTABLE_MIN_LOAD_FACTOR 0.125
+#endif
+
+/* The bit of a slot's hash field that marks its key as borrowed, which the table must not free: an atom from
+SymTable_intern or a key passed to SymTable_putBorrowed. The hash codes of a table never have this bit set. */
+#define BORROWED_BIT (~(size_t) 0 - (~(size_t) 0 >> 1))
+
+/* Defines a slot of the table that stores a key-value pair. */
+typedef struct Slot {
+  /* The key of this binding, stored as a dynamically allocated array of characters, or a borrowed key. */
+  char *key;
+  /* The value of this binding, stored as a generic pointer. */
+  void *value;
+  /* The hash code of key, kept so that growing the table never rehashes key, with BORROWED_BIT set if key is borrowed. */
+  size_t hash;
+  /* The length of key, not counting its terminating null character, which lets lookups reject most keys without reading
+  them. */
+  size_t keyLength;
+/* End of Slot struct definition. */
+} Slot;
+
+/* Defines an interned key. SymTable_intern hands out pointers to chars, so the header sits just before every atom. */
+typedef struct Atom {
+  /* The process-wide hash code and length of the key, so that tables never hash an atom. */
+  SymTable_Hash oHash;
+  /* The characters of the key. */
+  char chars[];
+/* End of Atom struct definition. */
+} Atom;
+
+/* Defines a symbol table structure. */
+struct SymTable {
+  /* capacity + GROUP_WIDTH control bytes. The last GROUP_WIDTH bytes mirror the first ones, so that a group can be loaded
+  starting at any slot without wrapping around. */
+  signed char *ctrl;
+  /* The array of capacity slots. Only slots whose control byte is non-negative hold a binding. */
+  Slot *slots;
+  /* The number of slots, a power of two. */
+  size_t capacity;
+  /* The total number of key-value bindings in the symbol table. */
+  size_t length;
+  /* The number of empty slots that may still be filled before the table is rebuilt, keeping the load at most 7/8. */
+  size_t growthLeft;
+  /* The process-wide seed of the key hash, the same in every table, so that a SymTable_hashKey code works in any of
+  them. */
+  uint64_t keySeed;
+  /* The random seed mixed into each key hash to give this table's own hash codes, so that keys which collide in one
+  table do not collide in another. */
+  uint64_t seed;
+  /* The allocator of all of this table's memory, including the table itself. */
+  SymTable_Allocator allocator;
+  /* The number of times the slot array has grown. */
+  size_t expansions;
+};
+
+/* Defines the work shared by the threads of one SymTable_mapParallel call. */
+typedef struct MapJob {
+  /* The table being traversed. */
+  SymTable_T oSymTable;
+  /* The function applied to each binding. */
+  void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra);
+  /* The additional argument passed to pfApply. */
+  void *pvExtra;
+  /* Guards next. */
+  pthread_mutex_t mutex;
+  /* The first slot not yet claimed by a thread. */
+  size_t next;
+/* End of MapJob struct definition. */
+} MapJob;
+
+/* Returns the hash code of oSymTable for a key whose process-wide hash code, as returned by SymTable_hashKey, is
+uKeyHash, less BORROWED_BIT. One multiply gives each table its own hash codes without hashing the key again. */
+static size_t SymTable_tableHash(SymTable_T oSymTable, size_t uKeyHash)
+{
+   return (size_t) SymTableHashFn_mix((uint64_t) uKeyHash ^ oSymTable -> seed, 0x9e3779b97f4a7c15ULL) & ~BORROWED_BIT;
+}
+
+/* Return a hash code for the uLength bytes of pvKey in oSymTable. Its low 7 bits go into the control bytes and the rest
+pick the first group. */
+static size_t SymTable_hashN(SymTable_T oSymTable, const void *pvKey, size_t uLength)
+{
+   assert(pvKey != NULL);
+
+   return SymTable_tableHash(oSymTable, (size_t) SymTableHashFn_bytes(pvKey, uLength, oSymTable -> keySeed));
+}
+
+/* Return a hash code for pcKey in oSymTable and store the length of pcKey in *puLength. */
+static size_t SymTable_hash(SymTable_T oSymTable, const char *pcKey, size_t *puLength)
+{
+   assert(pcKey != NULL);
+
+   *puLength = strlen(pcKey);
+   return SymTable_hashN(oSymTable, pcKey, *puLength);
+}
+
+/* Returns the number of bindings a table of uCapacity slots may hold before it is rebuilt. */
+static size_t SymTable_maxLoad(size_t uCapacity) {
+  return uCapacity - uCapacity / 8;
+}
+
+#if defined(__SSE2__)
+/* Returns a bit mask with bit i set if byte i of the group starting at pcGroup equals cByte. */
+static unsigned SymTable_matchByte(const signed char *pcGroup, signed char cByte) {
+  __m128i group = _mm_loadu_si128 ((const __m128i *) (const void *) pcGroup);
+  return (unsigned) _mm_movemask_epi8 (_mm_cmpeq_epi8 (group, _mm_set1_epi8 (cByte)));
+}
+
+/* Returns a bit mask with bit i set if slot i of the group starting at pcGroup is empty or deleted. */
+static unsigned SymTable_matchFree(const signed char *pcGroup) {
+  __m128i group = _mm_loadu_si128 ((const __m128i *) (const void *) pcGroup);
+  return (unsigned) _mm_movemask_epi8 (group);
+}
+#else
+/* Returns a bit mask with bit i set if byte i of the group starting at pcGroup equals cByte. */
+static unsigned SymTable_matchByte(const signed char *pcGroup, signed char cByte) {
+  unsigned mask = 0;
+  int i;
+  for (i = 0; i < GROUP_WIDTH; i++) {
+    if (pcGroup [i] == cByte) {
+      mask |= 1u << i;
+    }
+  }
+  return mask;
+}
+
+/* Returns a bit mask with bit i set if slot i of the group starting at pcGroup is empty or deleted. */
+static unsigned SymTable_matchFree(const signed char *pcGroup) {
+  unsigned mask = 0;
+  int i;
+  for (i = 0; i < GROUP_WIDTH; i++) {
+    if (pcGroup [i] < 0) {
+      mask |= 1u << i;
+    }
+  }
+  return mask;
+}
+#endif
+
+/* Returns the index of the lowest set bit of the non-zero mask uMask. */
+static size_t SymTable_lowestBit(unsigned uMask) {
+#if defined(__GNUC__)
+  return (size_t) __builtin_ctz (uMask);
+#else
+  size_t i = 0;
+  while ((uMask & 1u) == 0) {
+    uMask >>= 1;
+    i++;
+  }
+  return i;
+#endif
+}
+
+/* Returns a block of uSize bytes from malloc. pvContext is unused. */
+static void *SymTable_mallocBlock(size_t uSize, void *pvContext) {
+  (void) pvContext;
+  return malloc (uSize);
+}
+
+/* Gives pvBlock back to free. uSize and pvContext are unused. */
+static void SymTable_freeBlock(void *pvBlock, size_t uSize, void *pvContext) {
+  (void) uSize;
+  (void) pvContext;
+  free (pvBlock);
+}
+
+/* The allocator of the tables that are not given one. */
+static const SymTable_Allocator oDefaultAllocator = {SymTable_mallocBlock, SymTable_freeBlock, NULL};
+
+/* Returns a block of uSize bytes from the allocator of oSymTable, or NULL if there is insufficient memory. */
+static void *SymTable_alloc(SymTable_T oSymTable, size_t uSize) {
+  return (*oSymTable -> allocator.pfAlloc) (uSize, oSymTable -> allocator.pvContext);
+}
+
+/* Gives pvBlock, a block of uSize bytes, back to the allocator of oSymTable. */
+static void SymTable_release(SymTable_T oSymTable, void *pvBlock, size_t uSize) {
+  (*oSymTable -> allocator.pfFree) (pvBlock, uSize, oSymTable -> allocator.pvContext);
+}
+
+/* Frees the key of slot, a slot of oSymTable, unless it is borrowed. */
+static void SymTable_freeKey(SymTable_T oSymTable, const Slot *slot) {
+  if ((slot -> hash & BORROWED_BIT) == 0) {
+    SymTable_release (oSymTable, slot -> key, slot -> keyLength + 1);
+  }
+}
+
+/* Sets the control byte of slot i of oSymTable to cCtrl, keeping the mirrored bytes at the end of ctrl in sync. */
+static void SymTable_setCtrl(SymTable_T oSymTable, size_t i, signed char cCtrl) {
+  oSymTable -> ctrl [i] = cCtrl;
+  if (i < GROUP_WIDTH) {
+    oSymTable -> ctrl [oSymTable -> capacity + i] = cCtrl;
+  }
+}
+
+/* Returns the index of the slot of oSymTable holding pcKey, whose hash code is uHash and length is uLength, or capacity
+if there is none. Groups are visited in triangular order, which reaches every group of a power-of-two table. Only slots
+of the same length and hash code are compared with pcKey, and a slot holding the borrowed key pcKey is recognized by
+its pointer. If piFree is not NULL and pcKey is not found, *piFree is set to the first empty or deleted slot on the
+probe sequence, where pcKey can be inserted. */
+static size_t SymTable_find(SymTable_T oSymTable, const char *pcKey, size_t uHash, size_t uLength, size_t *piFree) {
+  size_t mask = oSymTable -> capacity - 1;
+  size_t pos = (uHash >> 7) & mask;
+  size_t probe = 0;
+  signed char h2 = (signed char) (uHash & H2_MASK);
+  const signed char *group;
+  unsigned match;
+  size_t i;
+  size_t freeIndex = oSymTable -> capacity;
+
+  for (;;) {
+    group = oSymTable -> ctrl + pos;
+    match = SymTable_matchByte (group, h2);
+    while (match != 0) {
+      i = (pos + SymTable_lowestBit (match)) & mask;
+      if (oSymTable -> slots [i].keyLength == uLength &&
+          (oSymTable -> slots [i].key == pcKey ||
+           ((oSymTable -> slots [i].hash & ~BORROWED_BIT) == uHash &&
+            memcmp (oSymTable -> slots [i].key, pcKey, uLength) == 0))) {
+        return i;
+      }
+      match &= match - 1;
+    }
+    if (piFree != NULL && freeIndex == oSymTable -> capacity) {
+      match = SymTable_matchFree (group);
+      if (match != 0) {
+        freeIndex = (pos + SymTable_lowestBit (match)) & mask;
+      }
+    }
+    if (SymTable_matchByte (group, CTRL_EMPTY) != 0) {
+      if (piFree != NULL) {
+        *piFree = freeIndex;
+      }
+      return oSymTable -> capacity;
+    }
+    probe += GROUP_WIDTH;
+    pos = (pos + probe) & mask;
+  }
+}
+
+/* Returns the index of the first empty or deleted slot on the probe sequence of uHash in oSymTable. */
+static size_t SymTable_findFree(SymTable_T oSymTable, size_t uHash) {
+  size_t mask = oSymTable -> capacity - 1;
+  size_t pos = (uHash >> 7) & mask;
+  size_t probe = 0;
+  unsigned match;
+
+  for (;;) {
+    match = SymTable_matchFree (oSymTable -> ctrl + pos);
+    if (match != 0) {
+      return (pos + SymTable_lowestBit (match)) & mask;
+    }
+    probe += GROUP_WIDTH;
+    pos = (pos + probe) & mask;
+  }
+}
+
+/* Allocates empty control and slot arrays of uCapacity slots for oSymTable. Returns 1 if successful, 0 otherwise, in which
+case oSymTable is unchanged. */
+static int SymTable_allocate(SymTable_T oSymTable, size_t uCapacity) {
+  signed char *newCtrl;
+  Slot *newSlots;
+
+  newCtrl = (signed char *) SymTable_alloc (oSymTable, uCapacity + GROUP_WIDTH);
+  if (newCtrl == NULL) {
+    return 0;
+  }
+  newSlots = (Slot *) SymTable_alloc (oSymTable, uCapacity * sizeof (Slot));
+  if (newSlots == NULL) {
+    SymTable_release (oSymTable, newCtrl, uCapacity + GROUP_WIDTH);
+    return 0;
+  }
+  memset (newCtrl, CTRL_EMPTY, uCapacity + GROUP_WIDTH);
+  oSymTable -> ctrl = newCtrl;
+  oSymTable -> slots = newSlots;
+  oSymTable -> capacity = uCapacity;
+  oSymTable -> growthLeft = SymTable_maxLoad (uCapacity) - oSymTable -> length;
+  return 1;
+}
+
+/* Moves the bindings of oSymTable into new arrays of uCapacity slots, which must be a power of two large enough to hold
+them, dropping all deleted slots on the way. Returns 1 if successful, 0 otherwise, in which case oSymTable is unchanged. */
+static int SymTable_resize(SymTable_T oSymTable, size_t uCapacity) {
+  signed char *oldCtrl = oSymTable -> ctrl;
+  Slot *oldSlots = oSymTable -> slots;
+  size_t oldCapacity = oSymTable -> capacity;
+  size_t i;
+  size_t newIndex;
+
+  if (!SymTable_allocate (oSymTable, uCapacity)) {
+    return 0;
+  }
+  if (uCapacity > oldCapacity) {
+    oSymTable -> expansions++;
+  }
+  for (i = 0; i < oldCapacity; i++) {
+    if (oldCtrl [i] >= 0) {
+      newIndex = SymTable_findFree (oSymTable, oldSlots [i].hash & ~BORROWED_BIT);
+      SymTable_setCtrl (oSymTable, newIndex, oldCtrl [i]);
+      oSymTable -> slots [newIndex] = oldSlots [i];
+    }
+  }
+  SymTable_release (oSymTable, oldCtrl, oldCapacity + GROUP_WIDTH);
+  SymTable_release (oSymTable, oldSlots, oldCapacity * sizeof (Slot));
+  return 1;
+}
+
+/* Rebuilds oSymTable once it has no growth left. The table doubles if it is more than half full of live bindings;
+otherwise it is rebuilt at the same size, which clears the deleted slots. Returns 1 if successful, 0 otherwise. */
+static int SymTable_rehash(SymTable_T oSymTable) {
+  size_t newCapacity = oSymTable -> capacity;
+
+  if (oSymTable -> length > SymTable_maxLoad (newCapacity) / 2) {
+    if (newCapacity > ((size_t) -1 - GROUP_WIDTH) / 2 / sizeof (Slot)) {
+      return 0;
+    }
+    newCapacity *= 2;
+  }
+  return SymTable_resize (oSymTable, newCapacity);
+}
+
+/* Returns the smallest capacity, a power of two no smaller than INITIAL_CAPACITY, that holds uCapacity bindings without
+being rebuilt, or 0 if that capacity would overflow. */
+static size_t SymTable_capacityFor(size_t uCapacity) {
+  size_t capacity = INITIAL_CAPACITY;
+  while (SymTable_maxLoad (capacity) < uCapacity) {
+    if (capacity > ((size_t) -1 - GROUP_WIDTH) / 2 / sizeof (Slot)) {
+      return 0;
+    }
+    capacity *= 2;
+  }
+  return capacity;
+}
+
+/* Makes oSymTable large enough to hold uCapacity bindings without being rebuilt. Returns 1 if successful, 0 otherwise. */
+int SymTable_reserve(SymTable_T oSymTable, size_t uCapacity) {
+  size_t capacity;
+  assert (oSymTable != NULL);
+
+  if (uCapacity <= oSymTable -> length + oSymTable -> growthLeft) {
+    return 1;
+  }
+  capacity = SymTable_capacityFor (uCapacity);
+  if (capacity == 0) {
+    return 0;
+  }
+  return SymTable_resize (oSymTable, capacity);
+}
+
+/* Shrinks oSymTable once removals have left fewer live bindings than SYMTABLE_MIN_LOAD_FACTOR of its slots, to the
+smallest capacity that holds twice its current bindings. If the smaller arrays cannot be allocated the table simply keeps
+its current ones. */
+static void SymTable_shrink(SymTable_T oSymTable) {
+  if (oSymTable -> capacity > INITIAL_CAPACITY &&
+      oSymTable -> length < (size_t) ((double) oSymTable -> capacity * SYMTABLE_MIN_LOAD_FACTOR)) {
+    (void) SymTable_resize (oSymTable, SymTable_capacityFor (2 * oSymTable -> length));
+  }
+}
+
+/* Shrinks oSymTable to the smallest capacity that holds its current bindings, which also clears its deleted slots. If
+the smaller arrays cannot be allocated the table is left as it is. */
+void SymTable_compact(SymTable_T oSymTable) {
+  assert (oSymTable != NULL);
+  (void) SymTable_resize (oSymTable, SymTable_capacityFor (oSymTable -> length));
+}
+
+/* Creates a new symbol table whose memory comes from *poAllocator, sized for uCapacity bindings, and returns a pointer
+to it */
+static SymTable_T SymTable_create(const SymTable_Allocator *poAllocator, size_t uCapacity) {
+  SymTable_T oSymTable;
+  size_t capacity = SymTable_capacityFor (uCapacity);
+  if (capacity == 0) {
+    return NULL;
+  }
+  oSymTable = (SymTable_T) (*poAllocator -> pfAlloc) (sizeof (struct SymTable), poAllocator -> pvContext);
+  if (oSymTable == NULL) {
+    return NULL;
+  }
+  oSymTable -> allocator = *poAllocator;
+  oSymTable -> length = 0;
+  oSymTable -> keySeed = SymTableHashFn_secret ();
+  oSymTable -> seed = SymTableHashFn_newSeed (oSymTable);
+  oSymTable -> expansions = 0;
+  if (!SymTable_allocate (oSymTable, capacity)) {
+    SymTable_release (oSymTable, oSymTable, sizeof (struct SymTable));
+    return NULL;
+  }
+  return oSymTable;
+}
+
+/* Creates a new symbol table and returns a pointer to it */
+SymTable_T SymTable_new(void) {
+  return SymTable_create (&oDefaultAllocator, 0);
+}
+
+/* Creates a new symbol table sized for uCapacity bindings and returns a pointer to it */
+SymTable_T SymTable_newWithCapacity(size_t uCapacity) {
+  return SymTable_create (&oDefaultAllocator, uCapacity);
+}
+
+/* Creates a new symbol table and returns a pointer to it. Bindings already live in one flat slot array, so this is the
+same as SymTable_new. */
+SymTable_T SymTable_newArena(void) {
+  return SymTable_new ();
+}
+
+/* Creates a new symbol table whose memory comes from a copy of *poAllocator and returns a pointer to it */
+SymTable_T SymTable_newWithAllocator(const SymTable_Allocator *poAllocator) {
+  assert (poAllocator != NULL);
+  assert (poAllocator -> pfAlloc != NULL);
+  assert (poAllocator -> pfFree != NULL);
+  return SymTable_create (poAllocator, 0);
+}
+
+/* Frees all the memory taken by oSymTable */
+void SymTable_free(SymTable_T oSymTable) {
+  size_t i;
+  assert (oSymTable != NULL);
+  for (i = 0; i < oSymTable -> capacity; i++) {
+    if (oSymTable -> ctrl [i] >= 0) {
+      SymTable_freeKey (oSymTable, &oSymTable -> slots [i]);
+    }
+  }
+  SymTable_release (oSymTable, oSymTable -> ctrl, oSymTable -> capacity + GROUP_WIDTH);
+  SymTable_release (oSymTable, oSymTable -> slots, oSymTable -> capacity * sizeof (Slot));
+  SymTable_release (oSymTable, oSymTable, sizeof (struct SymTable));
+}
+
+/* Returns the number of bindings in oSymTable */
+size_t SymTable_getLength(SymTable_T oSymTable) {
+  assert (oSymTable != NULL);
+  return (oSymTable -> length);
+}
+
+/* Finds the binding for pcKey, whose hash code in oSymTable is uHash and length is uLength, adding one with value pvValue
+if there is none, with a single probe sequence (plus a second one only when the table has to be rebuilt first). A new
+binding copies pcKey, unless iBorrowed is nonzero, in which case the binding points to pcKey. Sets *piAdded to 1 if the
+binding was added and 0 if it already existed. Returns the binding's slot, or NULL if a new binding could not be
+allocated. */
+static Slot *SymTable_insert(SymTable_T oSymTable, const char *pcKey, size_t uHash, size_t uLength, int iBorrowed,
+                             const void *pvValue, int *piAdded) {
+  size_t i;
+  size_t freeIndex;
+  char *key;
+
+  *piAdded = 0;
+  i = SymTable_find (oSymTable, pcKey, uHash, uLength, &freeIndex);
+  if (i != oSymTable -> capacity) {
+    return &oSymTable -> slots [i];
+  }
+
+  if (iBorrowed) {
+    key = (char *) pcKey;
+  }
+  else {
+    key = (char *) SymTable_alloc (oSymTable, uLength + 1);
+    if (key == NULL) {
+      return NULL;
+    }
+    memcpy (key, pcKey, uLength);
+    key [uLength] = '\0';
+  }
+
+  if (oSymTable -> ctrl [freeIndex] == CTRL_EMPTY && oSymTable -> growthLeft == 0) {
+    if (!SymTable_rehash (oSymTable)) {
+      if (!iBorrowed) {
+        SymTable_release (oSymTable, key, uLength + 1);
+      }
+      return NULL;
+    }
+    freeIndex = SymTable_findFree (oSymTable, uHash);
+  }
+
+  if (oSymTable -> ctrl [freeIndex] == CTRL_EMPTY) {
+    oSymTable -> growthLeft--;
+  }
+  SymTable_setCtrl (oSymTable, freeIndex, (signed char) (uHash & H2_MASK));
+  oSymTable -> slots [freeIndex].key = key;
+  oSymTable -> slots [freeIndex].value = (void *) pvValue;
+  oSymTable -> slots [freeIndex].hash = iBorrowed ? uHash | BORROWED_BIT : uHash;
+  oSymTable -> slots [freeIndex].keyLength = uLength;
+  oSymTable -> length++;
+  *piAdded = 1;
+  return &oSymTable -> slots [freeIndex];
+}
+
+/* Returns 1 if a new binding with key pcKey and value pvValue was successfully added to oSymTable, returns 0 if it was unsuccessful. */
+int SymTable_put(SymTable_T oSymTable, const char *pcKey, const void *pvValue) {
+  int iAdded;
+  size_t uHash;
+  size_t uLength;
+  assert (oSymTable != NULL);
+  assert (pcKey != NULL);
+
+  uHash = SymTable_hash (oSymTable, pcKey, &uLength);
+  (void) SymTable_insert (oSymTable, pcKey, uHash, uLength, 0, pvValue, &iAdded);
+  return iAdded;
+}
+
+/* Adds a binding of pcKey to pvValue in oSymTable, as SymTable_put does, but points to pcKey instead of copying it.
+Returns 1 if successful, or 0 if pcKey was already bound or there is insufficient memory. */
+int SymTable_putBorrowed(SymTable_T oSymTable, const char *pcKey, const void *pvValue) {
+  int iAdded;
+  size_t uHash;
+  size_t uLength;
+  assert (oSymTable != NULL);
+  assert (pcKey != NULL);
+
+  uHash = SymTable_hash (oSymTable, pcKey, &uLength);
+  (void) SymTable_insert (oSymTable, pcKey, uHash, uLength, 1, pvValue, &iAdded);
+  return iAdded;
+}
+
+/* Returns a pointer to the value bound to pcKey in oSymTable, first adding a binding of pcKey to pvValue if there is none,
+or NULL if there is insufficient memory. The pointer refers into the slot array, so it is invalidated by the next
+rebuild of the table. */
+void **SymTable_getOrPut(SymTable_T oSymTable, const char *pcKey, const void *pvValue) {
+  Slot *slot;
+  int iAdded;
+  size_t uHash;
+  size_t uLength;
+  assert (oSymTable != NULL);
+  assert (pcKey != NULL);
+
+  uHash = SymTable_hash (oSymTable, pcKey, &uLength);
+  slot = SymTable_insert (oSymTable, pcKey, uHash, uLength, 0, pvValue, &iAdded);
+  if (slot == NULL) {
+    return NULL;
+  }
+  return &slot -> value;
+}
+
+/* Replaces the value bound to pcKey with pvValue in oSymTable. */
+void *SymTable_replace(SymTable_T oSymTable, const char *pcKey, const void *pvValue) {
+  size_t i;
+  void *ogValue;
+  size_t uHash;
+  size_t uLength;
+  assert (oSymTable != NULL);
+  assert (pcKey != NULL);
+
+  uHash = SymTable_hash (oSymTable, pcKey, &uLength);
+  i = SymTable_find (oSymTable, pcKey, uHash, uLength, NULL);
+  if (i == oSymTable -> capacity) {
+    return NULL;
+  }
+  ogValue = oSymTable -> slots [i].value;
+  oSymTable -> slots [i].value = (void *) pvValue;
+  return ogValue;
+}
+
+/* Returns 1 if oSymTable has a binding for pcKey, returns 0 if it doesn't */
+int SymTable_contains(SymTable_T oSymTable, const char *pcKey) {
+  size_t uHash;
+  size_t uLength;
+  assert (oSymTable != NULL);
+  assert (pcKey != NULL);
+
+  uHash = SymTable_hash (oSymTable, pcKey, &uLength);
+  return SymTable_find (oSymTable, pcKey, uHash, uLength, NULL) != oSymTable -> capacity;
+}
+
+/* Returns the value bound to pcKey or NULL if not found in oSymTable. */
+void *SymTable_get(SymTable_T oSymTable, const char *pcKey) {
+  size_t i;
+  size_t uHash;
+  size_t uLength;
+  assert (oSymTable != NULL);
+  assert (pcKey != NULL);
+
+  uHash = SymTable_hash (oSymTable, pcKey, &uLength);
+  i = SymTable_find (oSymTable, pcKey, uHash, uLength, NULL);
+  if (i == oSymTable -> capacity) {
+    return NULL;
+  }
+  return oSymTable -> slots [i].value;
+}
+
+/* Returns the hash code of pcKey shared by every table of the process, together with its length. */
+SymTable_Hash SymTable_hashKey(const char *pcKey) {
+  SymTable_Hash oHash;
+  assert (pcKey != NULL);
+
+  oHash.uLength = strlen (pcKey);
+  oHash.uHash = (size_t) SymTableHashFn_bytes (pcKey, oHash.uLength, SymTableHashFn_secret ());
+  return oHash;
+}
+
+/* Adds a binding of pcKey, whose hash code oHash came from SymTable_hashKey, to pvValue in oSymTable, as SymTable_put
+does. Returns 1 if successful, or 0 if pcKey was already bound or there is insufficient memory. */
+int SymTable_putHashed(SymTable_T oSymTable, const char *pcKey, SymTable_Hash oHash, const void *pvValue) {
+  int iAdded;
+  assert (oSymTable != NULL);
+  assert (pcKey != NULL);
+
+  (void) SymTable_insert (oSymTable, pcKey, SymTable_tableHash (oSymTable, oHash.uHash), oHash.uLength, 0, pvValue,
+                          &iAdded);
+  return iAdded;
+}
+
+/* Returns 1 if oSymTable has a binding for pcKey, whose hash code oHash came from SymTable_hashKey, or 0 if it doesn't. */
+int SymTable_containsHashed(SymTable_T oSymTable, const char *pcKey, SymTable_Hash oHash) {
+  assert (oSymTable != NULL);
+  assert (pcKey != NULL);
+
+  return SymTable_find (oSymTable, pcKey, SymTable_tableHash (oSymTable, oHash.uHash), oHash.uLength, NULL) !=
+         oSymTable -> capacity;
+}
+
+/* Returns the value bound in oSymTable to pcKey, whose hash code oHash came from SymTable_hashKey, or NULL if there is
+none. */
+void *SymTable_getHashed(SymTable_T oSymTable, const char *pcKey, SymTable_Hash oHash) {
+  size_t i;
+  assert (oSymTable != NULL);
+  assert (pcKey != NULL);
+
+  i = SymTable_find (oSymTable, pcKey, SymTable_tableHash (oSymTable, oHash.uHash), oHash.uLength, NULL);
+  if (i == oSymTable -> capacity) {
+    return NULL;
+  }
+  return oSymTable -> slots [i].value;
+}
+
+/* Returns the header of pcAtom, which was returned by SymTable_intern. */
+static const Atom *SymTable_atom(const char *pcAtom) {
+  return (const Atom *) (const void *) (pcAtom - offsetof (Atom, chars));
+}
+
+/* Returns the atom equal to pcKey, adding it to the intern pool if it is new, or NULL if there is insufficient memory.
+The pool is itself a table, whose bindings are atoms bound to nothing; it lives as long as the process, and its mutex
+lets any thread intern keys. */
+const char *SymTable_intern(const char *pcKey) {
+  static SymTable_T oPool = NULL;
+  static pthread_mutex_t oPoolMutex = PTHREAD_MUTEX_INITIALIZER;
+  SymTable_Hash oHash;
+  const char *pcAtom = NULL;
+  Atom *atom;
+  size_t uHash;
+  size_t i;
+  int iAdded;
+  assert (pcKey != NULL);
+
+  oHash = SymTable_hashKey (pcKey);
+  pthread_mutex_lock (&oPoolMutex);
+  if (oPool == NULL) {
+    oPool = SymTable_new ();
+  }
+  if (oPool != NULL) {
+    uHash = SymTable_tableHash (oPool, oHash.uHash);
+    i = SymTable_find (oPool, pcKey, uHash, oHash.uLength, NULL);
+    if (i != oPool -> capacity) {
+      pcAtom = oPool -> slots [i].key;
+    }
+    else {
+      atom = (Atom *) malloc (offsetof (Atom, chars) + oHash.uLength + 1);
+      if (atom != NULL) {
+        atom -> oHash = oHash;
+        memcpy (atom -> chars, pcKey, oHash.uLength + 1);
+        if (SymTable_insert (oPool, atom -> chars, uHash, oHash.uLength, 1, NULL, &iAdded) != NULL) {
+          pcAtom = atom -> chars;
+        }
+        else {
+          free (atom);
+        }
+      }
+    }
+  }
+  pthread_mutex_unlock (&oPoolMutex);
+  return pcAtom;
+}
+
+/* Adds a binding of the atom pcAtom to pvValue in oSymTable, as SymTable_put does, without copying or hashing pcAtom.
+Returns 1 if successful, or 0 if pcAtom was already bound or there is insufficient memory. */
+int SymTable_putAtom(SymTable_T oSymTable, const char *pcAtom, const void *pvValue) {
+  const Atom *atom;
+  int iAdded;
+  assert (oSymTable != NULL);
+  assert (pcAtom != NULL);
+
+  atom = SymTable_atom (pcAtom);
+  (void) SymTable_insert (oSymTable, pcAtom, SymTable_tableHash (oSymTable, atom -> oHash.uHash), atom -> oHash.uLength,
+                          1, pvValue, &iAdded);
+  return iAdded;
+}
+
+/* Returns 1 if oSymTable has a binding for the atom pcAtom, or 0 if it doesn't. */
+int SymTable_containsAtom(SymTable_T oSymTable, const char *pcAtom) {
+  const Atom *atom;
+  assert (oSymTable != NULL);
+  assert (pcAtom != NULL);
+
+  atom = SymTable_atom (pcAtom);
+  return SymTable_find (oSymTable, pcAtom, SymTable_tableHash (oSymTable, atom -> oHash.uHash), atom -> oHash.uLength,
+                        NULL) != oSymTable -> capacity;
+}
+
+/* Returns the value bound to the atom pcAtom in oSymTable, or NULL if there is none. */
+void *SymTable_getAtom(SymTable_T oSymTable, const char *pcAtom) {
+  const Atom *atom;
+  size_t i;
+  assert (oSymTable != NULL);
+  assert (pcAtom != NULL);
+
+  atom = SymTable_atom (pcAtom);
+  i = SymTable_find (oSymTable, pcAtom, SymTable_tableHash (oSymTable, atom -> oHash.uHash), atom -> oHash.uLength, NULL);
+  if (i == oSymTable -> capacity) {
+    return NULL;
+  }
+  return oSymTable -> slots [i].value;
+}
+
+/* Looks up the uCount keys of apcKeys in oSymTable, GETMANY_BATCH at a time, storing their values in apvValues. Each
+batch goes through the memory accesses of a lookup in lockstep, as in symtablehash.c: the whole batch is hashed and the
+first control group of every key prefetched, then the slot of every first match, then the key of every such slot. Each
+pass reads what the one before prefetched, but its reads do not depend on one another, so their misses overlap and the
+batch waits about one miss per pass rather than one per key. The lookups then run on cached memory. Returns the number
+of keys found. */
+size_t SymTable_getMany(SymTable_T oSymTable, const char * const *apcKeys, size_t uCount, void **apvValues) {
+  size_t hashes[GETMANY_BATCH];
+  size_t lengths[GETMANY_BATCH];
+  size_t candidates[GETMANY_BATCH];
+  size_t mask;
+  size_t start;
+  size_t batch;
+  size_t found = 0;
+  size_t i;
+  size_t j;
+  unsigned match;
+  assert (oSymTable != NULL);
+  assert (apcKeys != NULL || uCount == 0);
+  assert (apvValues != NULL || uCount == 0);
+
+  mask = oSymTable -> capacity - 1;
+  for (start = 0; start < uCount; start += batch) {
+    batch = uCount - start < GETMANY_BATCH ? uCount - start : GETMANY_BATCH;
+    for (i = 0; i < batch; i++) {
+      hashes [i] = SymTable_hash (oSymTable, apcKeys [start + i], &lengths [i]);
+      SYMTABLE_PREFETCH (oSymTable -> ctrl + ((hashes [i] >> 7) & mask));
+    }
+    for (i = 0; i < batch; i++) {
+      match = SymTable_matchByte (oSymTable -> ctrl + ((hashes [i] >> 7) & mask), (signed char) (hashes [i] & H2_MASK));
+      candidates [i] = oSymTable -> capacity;
+      if (match != 0) {
+        candidates [i] = (((hashes [i] >> 7) & mask) + SymTable_lowestBit (match)) & mask;
+        SYMTABLE_PREFETCH (&oSymTable -> slots [candidates [i]]);
+      }
+    }
+    for (i = 0; i < batch; i++) {
+      if (candidates [i] != oSymTable -> capacity) {
+        SYMTABLE_PREFETCH (oSymTable -> slots [candidates [i]].key);
+      }
+    }
+    for (i = 0; i < batch; i++) {
+      j = SymTable_find (oSymTable, apcKeys [start + i], hashes [i], lengths [i], NULL);
+      apvValues [start + i] = NULL;
+      if (j != oSymTable -> capacity) {
+        apvValues [start + i] = oSymTable -> slots [j].value;
+        found++;
+      }
+    }
+  }
+  return found;
+}
+
+/* Removes the binding for pcKey, whose hash code in oSymTable is uHash and length is uLength, and returns its value, or
+NULL if there is none. The slot is marked deleted rather than empty so that probes for other keys continue past it. */
+static void *SymTable_delete(SymTable_T oSymTable, const char *pcKey, size_t uHash, size_t uLength) {
+  size_t i;
+  void *value;
+
+  i = SymTable_find (oSymTable, pcKey, uHash, uLength, NULL);
+  if (i == oSymTable -> capacity) {
+    return NULL;
+  }
+  value = oSymTable -> slots [i].value;
+  SymTable_freeKey (oSymTable, &oSymTable -> slots [i]);
+  SymTable_setCtrl (oSymTable, i, CTRL_DELETED);
+  oSymTable -> length--;
+  SymTable_shrink (oSymTable);
+  return value;
+}
+
+/* Removes the value bound to pcKey, returns the removed value or NULL if not found in oSymTable. */
+void *SymTable_remove(SymTable_T oSymTable, const char *pcKey) {
+  size_t uHash;
+  size_t uLength;
+  assert (oSymTable != NULL);
+  assert (pcKey != NULL);
+
+  uHash = SymTable_hash (oSymTable, pcKey, &uLength);
+  return SymTable_delete (oSymTable, pcKey, uHash, uLength);
+}
+
+/* Replaces the value bound to pcKey, whose process-wide hash code and length are oHash, with pvValue in oSymTable and
+returns the old value, or NULL if pcKey is not bound. */
+void *SymTable_replaceHashed(SymTable_T oSymTable, const char *pcKey, SymTable_Hash oHash, const void *pvValue) {
+  size_t i;
+  void *ogValue;
+  assert (oSymTable != NULL);
+  assert (pcKey != NULL);
+
+  i = SymTable_find (oSymTable, pcKey, SymTable_tableHash (oSymTable, oHash.uHash), oHash.uLength, NULL);
+  if (i == oSymTable -> capacity) {
+    return NULL;
+  }
+  ogValue = oSymTable -> slots [i].value;
+  oSymTable -> slots [i].value = (void *) pvValue;
+  return ogValue;
+}
+
+/* Removes the binding for pcKey, whose process-wide hash code and length are oHash, and returns its value, or NULL if
+there is none. */
+void *SymTable_removeHashed(SymTable_T oSymTable, const char *pcKey, SymTable_Hash oHash) {
+  assert (oSymTable != NULL);
+  assert (pcKey != NULL);
+
+  return SymTable_delete (oSymTable, pcKey, SymTable_tableHash (oSymTable, oHash.uHash), oHash.uLength);
+}
+
+/* Adds a binding of the key made of the uLength bytes at pvKey to pvValue in oSymTable, as SymTable_put does. Returns 1
+if successful, or 0 if the key was already bound or there is insufficient memory. */
+int SymTable_putN(SymTable_T oSymTable, const void *pvKey, size_t uLength, const void *pvValue) {
+  int iAdded;
+  assert (oSymTable != NULL);
+  assert (pvKey != NULL);
+
+  (void) SymTable_insert (oSymTable, (const char *) pvKey, SymTable_hashN (oSymTable, pvKey, uLength), uLength, 0,
+                          pvValue, &iAdded);
+  return iAdded;
+}
+
+/* Returns 1 if oSymTable has a binding for the key made of the uLength bytes at pvKey, or 0 if it doesn't. */
+int SymTable_containsN(SymTable_T oSymTable, const void *pvKey, size_t uLength) {
+  assert (oSymTable != NULL);
+  assert (pvKey != NULL);
+
+  return SymTable_find (oSymTable, (const char *) pvKey, SymTable_hashN (oSymTable, pvKey, uLength), uLength, NULL) !=
+         oSymTable -> capacity;
+}
+
+/* Returns the value bound to the key made of the uLength bytes at pvKey in oSymTable, or NULL if there is none. */
+void *SymTable_getN(SymTable_T oSymTable, const void *pvKey, size_t uLength) {
+  size_t i;
+  assert (oSymTable != NULL);
+  assert (pvKey != NULL);
+
+  i = SymTable_find (oSymTable, (const char *) pvKey, SymTable_hashN (oSymTable, pvKey, uLength), uLength, NULL);
+  if (i == oSymTable -> capacity) {
+    return NULL;
+  }
+  return oSymTable -> slots [i].value;
+}
+
+/* Removes the binding for the key made of the uLength bytes at pvKey from oSymTable and returns its value, or NULL if
+there is none. */
+void *SymTable_removeN(SymTable_T oSymTable, const void *pvKey, size_t uLength) {
+  assert (oSymTable != NULL);
+  assert (pvKey != NULL);
+
+  return SymTable_delete (oSymTable, (const char *) pvKey, SymTable_hashN (oSymTable, pvKey, uLength), uLength);
+}
+
+/* Fills *poStats with the shape and memory use of oSymTable. The chain of a binding is the number of groups a lookup
+probes to reach it, found by replaying the triangular probe sequence from the group its hash code starts in. */
+void SymTable_getStats(SymTable_T oSymTable, SymTable_Stats *poStats) {
+  size_t mask;
+  size_t pos;
+  size_t probe;
+  size_t groups;
+  size_t probes = 0;
+  size_t i;
+  assert (oSymTable != NULL);
+  assert (poStats != NULL);
+
+  memset (poStats, 0, sizeof (SymTable_Stats));
+  poStats -> uLength = oSymTable -> length;
+  poStats -> uBucketCount = oSymTable -> capacity;
+  poStats -> dLoadFactor = (double) oSymTable -> length / (double) oSymTable -> capacity;
+  poStats -> uExpansions = oSymTable -> expansions;
+  mask = oSymTable -> capacity - 1;
+  for (i = 0; i < oSymTable -> capacity; i++) {
+    if (oSymTable -> ctrl [i] < 0) {
+      continue;
+    }
+    pos = ((oSymTable -> slots [i].hash & ~BORROWED_BIT) >> 7) & mask;
+    probe = 0;
+    groups = 1;
+    while (((i - pos) & mask) >= GROUP_WIDTH) {
+      probe += GROUP_WIDTH;
+      pos = (pos + probe) & mask;
+      groups++;
+    }
+    poStats -> auChainHistogram [groups - 1 < SYMTABLE_STATS_HISTOGRAM_SIZE ? groups - 1 :
+                                 SYMTABLE_STATS_HISTOGRAM_SIZE - 1]++;
+    if (groups > poStats -> uMaxChain) {
+      poStats -> uMaxChain = groups;
+    }
+    probes += groups;
+    if ((oSymTable -> slots [i].hash & BORROWED_BIT) == 0) {
+      poStats -> uKeyBytes += oSymTable -> slots [i].keyLength + 1;
+    }
+  }
+  if (oSymTable -> length > 0) {
+    poStats -> dAvgChain = (double) probes / (double) oSymTable -> length;
+    poStats -> dAvgProbe = poStats -> dAvgChain;
+  }
+  poStats -> uTableBytes = sizeof (struct SymTable);
+  poStats -> uBucketBytes = oSymTable -> capacity + GROUP_WIDTH + oSymTable -> capacity * sizeof (Slot);
+}
+
+/* Applies the function pointed to by pfApply to each binding with key pcKey and value pvValue in the oSymTable, passing an additional
+user-specified argument pvExtra. */
+void SymTable_map(SymTable_T oSymTable, void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra), const void *pvExtra) {
+  size_t i;
+  assert (oSymTable != NULL);
+  assert (pfApply != NULL);
+
+  for (i = 0; i < oSymTable -> capacity; i++) {
+    if (oSymTable -> ctrl [i] >= 0) {
+      (*pfApply) (oSymTable -> slots [i].key, oSymTable -> slots [i].value, (void *) pvExtra);
+    }
+  }
+}
+
+/* Claims the next range of slots of pJob for the calling thread. Returns the first index of the range and sets *puEnd
+past its last one, or returns *puEnd when nothing is left. */
+static size_t SymTable_mapClaim(MapJob *pJob, size_t *puEnd) {
+  size_t start;
+  pthread_mutex_lock (&pJob -> mutex);
+  start = pJob -> next;
+  if (pJob -> oSymTable -> capacity - start > MAP_CHUNK_SLOTS) {
+    pJob -> next = start + MAP_CHUNK_SLOTS;
+  }
+  else {
+    pJob -> next = pJob -> oSymTable -> capacity;
+  }
+  *puEnd = pJob -> next;
+  pthread_mutex_unlock (&pJob -> mutex);
+  return start;
+}
+
+/* Applies the function of the MapJob pointed to by pvJob to the bindings in each range the calling thread claims, until
+none are left. Threads that finish their ranges early simply claim more, so the work evens out across threads. */
+static void *SymTable_mapWorker(void *pvJob) {
+  MapJob *pJob = (MapJob *) pvJob;
+  SymTable_T oSymTable = pJob -> oSymTable;
+  size_t i;
+  size_t end;
+
+  for (i = SymTable_mapClaim (pJob, &end); i < end; i = SymTable_mapClaim (pJob, &end)) {
+    for (; i < end; i++) {
+      if (oSymTable -> ctrl [i] >= 0) {
+        (*pJob -> pfApply) (oSymTable -> slots [i].key, oSymTable -> slots [i].value, pJob -> pvExtra);
+      }
+    }
+  }
+  return NULL;
+}
+
+/* Applies pfApply to each binding of oSymTable with the length of its key. */
+void SymTable_mapN(SymTable_T oSymTable, void (*pfApply)(const void *pvKey, size_t uLength, void *pvValue, void *pvExtra),
+                   const void *pvExtra) {
+  size_t i;
+  assert (oSymTable != NULL);
+  assert (pfApply != NULL);
+
+  for (i = 0; i < oSymTable -> capacity; i++) {
+    if (oSymTable -> ctrl [i] >= 0) {
+      (*pfApply) (oSymTable -> slots [i].key, oSymTable -> slots [i].keyLength, oSymTable -> slots [i].value,
+                  (void *) pvExtra);
+    }
+  }
+}
+
+/* Applies pfApply to each binding of oSymTable on up to uThreadCount threads. The threads share out the slot array in
+ranges. The calling thread works too, and if some threads cannot be started the others do their share. */
+void SymTable_mapParallel(SymTable_T oSymTable, void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+                          const void *pvExtra, size_t uThreadCount) {
+  MapJob job;
+  pthread_t *threads;
+  size_t uChunkCount;
+  size_t started = 0;
+  size_t i;
+  assert (oSymTable != NULL);
+  assert (pfApply != NULL);
+
+  if (uThreadCount <= 1 || oSymTable -> capacity <= MAP_CHUNK_SLOTS) {
+    SymTable_map (oSymTable, pfApply, pvExtra);
+    return;
+  }
+  /* A thread beyond one per chunk of slots would find nothing to claim. The cap also keeps the size of the
+  array of threads from overflowing. */
+  uChunkCount = (oSymTable -> capacity + MAP_CHUNK_SLOTS - 1) / MAP_CHUNK_SLOTS;
+  if (uThreadCount > uChunkCount) {
+    uThreadCount = uChunkCount;
+  }
+
+  job.oSymTable = oSymTable;
+  job.pfApply = pfApply;
+  job.pvExtra = (void *) pvExtra;
+  job.next = 0;
+  if (pthread_mutex_init (&job.mutex, NULL) != 0) {
+    SymTable_map (oSymTable, pfApply, pvExtra);
+    return;
+  }
+  threads = (pthread_t *) malloc ((uThreadCount - 1) * sizeof (pthread_t));
+  if (threads != NULL) {
+    for (i = 0; i < uThreadCount - 1; i++) {
+      if (pthread_create (&threads [started], NULL, SymTable_mapWorker, &job) == 0) {
+        started++;
+      }
+    }
+  }
+  (void) SymTable_mapWorker (&job);
+  for (i = 0; i < started; i++) {
+    pthread_join (threads [i], NULL);
+  }
+  free (threads);
+  pthread_mutex_destroy (&job.mutex);
+}
+
+/* Removes every binding of oSymTable for which pfPred returns nonzero, unlinking each one as the sweep reaches it, and
+returns the number removed. pfOnRemoved, if not NULL, sees each binding just before it goes. */
+size_t SymTable_removeIf(SymTable_T oSymTable, int (*pfPred)(const char *pcKey, void *pvValue, void *pvExtra),
+                         const void *pvExtra, void (*pfOnRemoved)(const char *pcKey, void *pvValue, void *pvExtra)) {
+  SymTable_Iter oIter;
+  size_t uRemoved = 0;
+  assert (oSymTable != NULL);
+  assert (pfPred != NULL);
+
+  for (SymTable_iterBegin (oSymTable, &oIter); SymTable_iterNext (&oIter); ) {
+    if ((*pfPred) (SymTable_iterKey (&oIter), SymTable_iterValue (&oIter), (void *) pvExtra)) {
+      if (pfOnRemoved != NULL) {
+        (*pfOnRemoved) (SymTable_iterKey (&oIter), SymTable_iterValue (&oIter), (void *) pvExtra);
+      }
+      (void) SymTable_iterRemoveCurrent (&oIter);
+      uRemoved++;
+    }
+  }
+  return uRemoved;
+}
+
+/* Sets up poIter to traverse the slots of oSymTable from the first one. */
+void SymTable_iterBegin(SymTable_T oSymTable, SymTable_Iter *poIter) {
+  assert (oSymTable != NULL);
+  assert (poIter != NULL);
+
+  poIter -> oSymTable = oSymTable;
+  poIter -> uIndex = 0;
+  poIter -> pvLink = NULL;
+  poIter -> pvCurrent = NULL;
+  poIter -> iRemoved = 0;
+}
+
+/* Moves poIter to the next full slot of its table. Returns 1 if there is one, or 0 at the end, where a shrink put off by
+SymTable_iterRemoveCurrent happens if the traversal removed any binding. */
+int SymTable_iterNext(SymTable_Iter *poIter) {
+  SymTable_T oSymTable;
+  size_t i;
+  assert (poIter != NULL);
+
+  oSymTable = poIter -> oSymTable;
+  for (i = poIter -> uIndex; i < oSymTable -> capacity; i++) {
+    if (oSymTable -> ctrl [i] >= 0) {
+      poIter -> uIndex = i + 1;
+      poIter -> pvCurrent = &oSymTable -> slots [i];
+      return 1;
+    }
+  }
+  if (poIter -> uIndex != (size_t) -1) {
+    poIter -> uIndex = (size_t) -1;
+    if (poIter -> iRemoved) {
+      SymTable_shrink (oSymTable);
+    }
+  }
+  poIter -> pvCurrent = NULL;
+  return 0;
+}
+
+/* Returns the key of the current binding of poIter. */
+const char *SymTable_iterKey(const SymTable_Iter *poIter) {
+  assert (poIter != NULL);
+  assert (poIter -> pvCurrent != NULL);
+  return ((Slot *) poIter -> pvCurrent) -> key;
+}
+
+/* Returns the length of the key of the current binding of poIter, as stored with the key. */
+size_t SymTable_iterKeyLength(const SymTable_Iter *poIter) {
+  assert (poIter != NULL);
+  assert (poIter -> pvCurrent != NULL);
+  return ((Slot *) poIter -> pvCurrent) -> keyLength;
+}
+
+/* Returns the value of the current binding of poIter. */
+void *SymTable_iterValue(const SymTable_Iter *poIter) {
+  assert (poIter != NULL);
+  assert (poIter -> pvCurrent != NULL);
+  return ((Slot *) poIter -> pvCurrent) -> value;
+}
+
+/* Marks the current slot of poIter deleted, frees its key and returns its value. */
+void *SymTable_iterRemoveCurrent(SymTable_Iter *poIter) {
+  SymTable_T oSymTable;
+  Slot *slot;
+  assert (poIter != NULL);
+  assert (poIter -> pvCurrent != NULL);
+
+  oSymTable = poIter -> oSymTable;
+  slot = (Slot *) poIter -> pvCurrent;
+  SymTable_freeKey (oSymTable, slot);
+  SymTable_setCtrl (oSymTable, (size_t) (slot - oSymTable -> slots), CTRL_DELETED);
+  oSymTable -> length--;
+  poIter -> pvCurrent = NULL;
+  poIter -> iRemoved = 1;
+  return slot -> value;
+}
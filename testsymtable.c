@@ -83,6 +83,119 @@ static void printBindingSimple(const char *pcKey, void *pvValue,
 
 /*--------------------------------------------------------------------*/
 
+/* Return 1 if the int value pvValue is a multiple of the int pointed
+   to by pvExtra, and 0 otherwise. pcKey is unused. */
+
+static int isMultiple(const char *pcKey, void *pvValue, void *pvExtra)
+{
+   assert(pcKey != NULL);
+   assert(pvValue != NULL);
+   assert(pvExtra != NULL);
+
+   return *(int*)pvValue % *(int*)pvExtra == 0;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Count a binding removed by SymTable_removeIf, whose int value
+   pvValue must be a multiple of the int pointed to by pvExtra, by
+   negating that value. pcKey is unused. */
+
+static void countRemoved(const char *pcKey, void *pvValue,
+   void *pvExtra)
+{
+   assert(pcKey != NULL);
+   assert(pvValue != NULL);
+   assert(pvExtra != NULL);
+
+   ASSURE(*(int*)pvValue % *(int*)pvExtra == 0);
+   *(int*)pvValue = -1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Increment the int value pvValue. Each binding has its own value, so
+   this is safe to call on different bindings at once. pcKey and
+   pvExtra are unused. */
+
+static void incrementValue(const char *pcKey, void *pvValue,
+   void *pvExtra)
+{
+   assert(pcKey != NULL);
+   assert(pvValue != NULL);
+   assert(pvExtra == NULL);
+
+   (*(int*)pvValue)++;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* The state of the counting allocator of testAllocator. */
+
+struct Counter
+{
+   /* The number of blocks allocated and not yet freed. */
+   long lBlocks;
+   /* The number of bytes in those blocks. */
+   size_t uBytes;
+   /* The number of allocations that may still succeed, or -1 if
+      there is no limit. */
+   long lBudget;
+};
+
+/* The size of the header in which countingAlloc records the size of
+   each block, a multiple of any alignment malloc guarantees. */
+enum {COUNTER_HEADER_SIZE = 16};
+
+/*--------------------------------------------------------------------*/
+
+/* Return a block of uSize bytes, recorded in the struct Counter
+   pointed to by pvContext, or NULL if its budget is used up. */
+
+static void *countingAlloc(size_t uSize, void *pvContext)
+{
+   struct Counter *poCounter = (struct Counter*)pvContext;
+   char *pcBlock;
+
+   assert(poCounter != NULL);
+
+   if (poCounter->lBudget == 0)
+      return NULL;
+   pcBlock = (char*)malloc(COUNTER_HEADER_SIZE + uSize);
+   if (pcBlock == NULL)
+      return NULL;
+   if (poCounter->lBudget > 0)
+      poCounter->lBudget--;
+   memcpy(pcBlock, &uSize, sizeof(uSize));
+   poCounter->lBlocks++;
+   poCounter->uBytes += uSize;
+   return pcBlock + COUNTER_HEADER_SIZE;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Free pvBlock, which countingAlloc returned for uSize bytes, and
+   remove it from the struct Counter pointed to by pvContext. */
+
+static void countingFree(void *pvBlock, size_t uSize, void *pvContext)
+{
+   struct Counter *poCounter = (struct Counter*)pvContext;
+   char *pcBlock;
+   size_t uAllocated;
+
+   assert(pvBlock != NULL);
+   assert(poCounter != NULL);
+
+   pcBlock = (char*)pvBlock - COUNTER_HEADER_SIZE;
+   memcpy(&uAllocated, pcBlock, sizeof(uAllocated));
+   ASSURE(uAllocated == uSize);
+   poCounter->lBlocks--;
+   poCounter->uBytes -= uSize;
+   free(pcBlock);
+}
+
+/*--------------------------------------------------------------------*/
+
 /* Test the most basic SymTable functions. */
 
 static void testBasics(void)
@@ -776,6 +889,1112 @@ static void testCollisions(void)
 
 /*--------------------------------------------------------------------*/
 
+/* Test the SymTable_getOrPut() function. */
+
+static void testGetOrPut(void)
+{
+   SymTable_T oSymTable;
+   char acShortstop[] = "Shortstop";
+   char acCenterField[] = "Center Field";
+   void **ppvValue;
+   char *pcValue;
+   size_t uLength;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the SymTable_getOrPut() function.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   /* A missing key is added with the given value. */
+   ppvValue = SymTable_getOrPut(oSymTable, "Jeter", acShortstop);
+   ASSURE(ppvValue != NULL);
+   ASSURE((ppvValue != NULL) && (*ppvValue == acShortstop));
+
+   uLength = SymTable_getLength(oSymTable);
+   ASSURE(uLength == 1);
+
+   /* An existing key keeps its value, which can be replaced through
+      the returned pointer. */
+   ppvValue = SymTable_getOrPut(oSymTable, "Jeter", acCenterField);
+   ASSURE((ppvValue != NULL) && (*ppvValue == acShortstop));
+   if (ppvValue != NULL)
+      *ppvValue = acCenterField;
+
+   pcValue = (char*)SymTable_get(oSymTable, "Jeter");
+   ASSURE(pcValue == acCenterField);
+
+   uLength = SymTable_getLength(oSymTable);
+   ASSURE(uLength == 1);
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test SymTable_newWithCapacity() and SymTable_reserve(). */
+
+static void testCapacity(void)
+{
+   enum {BINDING_COUNT = 5000, MAX_KEY_LENGTH = 10};
+
+   SymTable_T oSymTable;
+   char acKey[MAX_KEY_LENGTH];
+   char acShortstop[] = "Shortstop";
+   char *pcValue;
+   int i;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_newWithCapacity() and SymTable_reserve().\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_newWithCapacity(BINDING_COUNT);
+   ASSURE(oSymTable != NULL);
+   ASSURE(SymTable_getLength(oSymTable) == 0);
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, acShortstop);
+      ASSURE(iSuccessful);
+   }
+
+   /* Reserving more room keeps every binding. */
+   iSuccessful = SymTable_reserve(oSymTable, 4 * BINDING_COUNT);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_reserve(oSymTable, 1);
+   ASSURE(iSuccessful);
+   ASSURE(SymTable_getLength(oSymTable) == BINDING_COUNT);
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      pcValue = (char*)SymTable_get(oSymTable, acKey);
+      ASSURE(pcValue == acShortstop);
+   }
+   SymTable_free(oSymTable);
+
+   /* Reserving room in a new, empty table. */
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   iSuccessful = SymTable_reserve(oSymTable, BINDING_COUNT);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTable, "Jeter", acShortstop);
+   ASSURE(iSuccessful);
+   pcValue = (char*)SymTable_get(oSymTable, "Jeter");
+   ASSURE(pcValue == acShortstop);
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test SymTable_compact() and shrinking after mass removal. */
+
+static void testCompact(void)
+{
+   enum {BINDING_COUNT = 5000, KEPT_COUNT = 100, MAX_KEY_LENGTH = 10};
+
+   SymTable_T oSymTable;
+   char acKey[MAX_KEY_LENGTH];
+   char acShortstop[] = "Shortstop";
+   char *pcValue;
+   int i;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_compact().\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, acShortstop);
+      ASSURE(iSuccessful);
+   }
+
+   /* Removing most bindings shrinks the table as it goes. */
+   for (i = KEPT_COUNT; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      pcValue = (char*)SymTable_remove(oSymTable, acKey);
+      ASSURE(pcValue == acShortstop);
+   }
+   ASSURE(SymTable_getLength(oSymTable) == KEPT_COUNT);
+   SymTable_compact(oSymTable);
+   ASSURE(SymTable_getLength(oSymTable) == KEPT_COUNT);
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      pcValue = (char*)SymTable_get(oSymTable, acKey);
+      ASSURE((i < KEPT_COUNT) == (pcValue == acShortstop));
+   }
+
+   /* Compacting down to a few bindings, then growing again. */
+   for (i = 1; i < KEPT_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      pcValue = (char*)SymTable_remove(oSymTable, acKey);
+      ASSURE(pcValue == acShortstop);
+   }
+   SymTable_compact(oSymTable);
+   ASSURE(SymTable_getLength(oSymTable) == 1);
+   ASSURE(SymTable_contains(oSymTable, "0"));
+   for (i = 1; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, acShortstop);
+      ASSURE(iSuccessful);
+   }
+   ASSURE(SymTable_getLength(oSymTable) == BINDING_COUNT);
+   SymTable_compact(oSymTable);
+   ASSURE(SymTable_getLength(oSymTable) == BINDING_COUNT);
+   pcValue = (char*)SymTable_get(oSymTable, "4999");
+   ASSURE(pcValue == acShortstop);
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the SymTable_Iter cursor functions. */
+
+static void testIterator(void)
+{
+   enum {BINDING_COUNT = 5000, MAX_KEY_LENGTH = 10};
+
+   SymTable_T oSymTable;
+   SymTable_Iter oIter;
+   SymTable_Stats oBefore;
+   SymTable_Stats oAfter;
+   char acKey[MAX_KEY_LENGTH];
+   int aiValues[BINDING_COUNT];
+   int aiSeen[BINDING_COUNT];
+   int *piValue;
+   int iCount;
+   int i;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the SymTable_Iter cursor functions.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   /* An empty table has nothing to visit. */
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   SymTable_iterBegin(oSymTable, &oIter);
+   ASSURE(! SymTable_iterNext(&oIter));
+   ASSURE(! SymTable_iterNext(&oIter));
+
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      aiValues[i] = i;
+      aiSeen[i] = 0;
+      sprintf(acKey, "%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, &aiValues[i]);
+      ASSURE(iSuccessful);
+   }
+
+   /* Every binding is visited exactly once. */
+   iCount = 0;
+   for (SymTable_iterBegin(oSymTable, &oIter); SymTable_iterNext(&oIter); )
+   {
+      piValue = (int*)SymTable_iterValue(&oIter);
+      sprintf(acKey, "%d", *piValue);
+      ASSURE(strcmp(SymTable_iterKey(&oIter), acKey) == 0);
+      aiSeen[*piValue]++;
+      iCount++;
+   }
+   ASSURE(iCount == BINDING_COUNT);
+   for (i = 0; i < BINDING_COUNT; i++)
+      ASSURE(aiSeen[i] == 1);
+
+   /* A traversal can stop as soon as it finds what it wants. */
+   iCount = 0;
+   for (SymTable_iterBegin(oSymTable, &oIter); SymTable_iterNext(&oIter); )
+   {
+      iCount++;
+      if (strcmp(SymTable_iterKey(&oIter), "1234") == 0)
+         break;
+   }
+   ASSURE(iCount <= BINDING_COUNT);
+   ASSURE(*(int*)SymTable_iterValue(&oIter) == 1234);
+
+   /* Removing the current binding keeps the traversal going. */
+   iCount = 0;
+   for (SymTable_iterBegin(oSymTable, &oIter); SymTable_iterNext(&oIter); )
+   {
+      iCount++;
+      piValue = (int*)SymTable_iterValue(&oIter);
+      if (*piValue % 2 == 0)
+         ASSURE(SymTable_iterRemoveCurrent(&oIter) == piValue);
+   }
+   ASSURE(iCount == BINDING_COUNT);
+   ASSURE(SymTable_getLength(oSymTable) == BINDING_COUNT / 2);
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTable_contains(oSymTable, acKey) == (i % 2 != 0));
+   }
+
+   /* Removing every binding leaves a usable empty table. */
+   for (SymTable_iterBegin(oSymTable, &oIter); SymTable_iterNext(&oIter); )
+      SymTable_iterRemoveCurrent(&oIter);
+   ASSURE(SymTable_getLength(oSymTable) == 0);
+   SymTable_iterBegin(oSymTable, &oIter);
+   ASSURE(! SymTable_iterNext(&oIter));
+   iSuccessful = SymTable_put(oSymTable, "Jeter", &aiValues[0]);
+   ASSURE(iSuccessful);
+   ASSURE(SymTable_get(oSymTable, "Jeter") == &aiValues[0]);
+
+   /* A traversal that removes nothing leaves the room reserved for
+      the table alone, even though the table is nearly empty. */
+   iSuccessful = SymTable_reserve(oSymTable, 20 * BINDING_COUNT);
+   ASSURE(iSuccessful);
+   SymTable_getStats(oSymTable, &oBefore);
+   iCount = 0;
+   for (SymTable_iterBegin(oSymTable, &oIter); SymTable_iterNext(&oIter); )
+      iCount++;
+   ASSURE(iCount == 1);
+   SymTable_getStats(oSymTable, &oAfter);
+   ASSURE(oAfter.uBucketCount == oBefore.uBucketCount);
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test SymTable_removeIf(). */
+
+static void testRemoveIf(void)
+{
+   enum {BINDING_COUNT = 5000, MAX_KEY_LENGTH = 10};
+
+   SymTable_T oSymTable;
+   char acKey[MAX_KEY_LENGTH];
+   int aiValues[BINDING_COUNT];
+   int iDivisor;
+   size_t uRemoved;
+   int i;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_removeIf().\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      aiValues[i] = i;
+      sprintf(acKey, "%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, &aiValues[i]);
+      ASSURE(iSuccessful);
+   }
+
+   /* Removing the multiples of 3, with a callback. */
+   iDivisor = 3;
+   uRemoved = SymTable_removeIf(oSymTable, isMultiple, &iDivisor,
+      countRemoved);
+   ASSURE(uRemoved == (BINDING_COUNT + 2) / 3);
+   ASSURE(SymTable_getLength(oSymTable) == BINDING_COUNT - uRemoved);
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTable_contains(oSymTable, acKey) == (i % 3 != 0));
+      ASSURE((aiValues[i] == -1) == (i % 3 == 0));
+   }
+
+   /* Nothing matches a second time. */
+   uRemoved = SymTable_removeIf(oSymTable, isMultiple, &iDivisor,
+      NULL);
+   ASSURE(uRemoved == 0);
+
+   /* Removing everything that is left, without a callback. */
+   iDivisor = 1;
+   uRemoved = SymTable_removeIf(oSymTable, isMultiple, &iDivisor,
+      NULL);
+   ASSURE(uRemoved == BINDING_COUNT - (BINDING_COUNT + 2) / 3);
+   ASSURE(SymTable_getLength(oSymTable) == 0);
+   iSuccessful = SymTable_put(oSymTable, "Jeter", &aiValues[1]);
+   ASSURE(iSuccessful);
+   ASSURE(SymTable_getLength(oSymTable) == 1);
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test SymTable_mapParallel(). */
+
+static void testMapParallel(void)
+{
+   enum {BINDING_COUNT = 10000, MAX_KEY_LENGTH = 10};
+
+   SymTable_T oSymTable;
+   char acKey[MAX_KEY_LENGTH];
+   static int aiValues[BINDING_COUNT];
+   size_t uThreadCount;
+   int i;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_mapParallel().\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   /* An empty table has nothing to visit. */
+   SymTable_mapParallel(oSymTable, incrementValue, NULL, 4);
+
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      aiValues[i] = 0;
+      sprintf(acKey, "%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, &aiValues[i]);
+      ASSURE(iSuccessful);
+   }
+
+   /* Every binding is visited exactly once, whatever the number of
+      threads. */
+   for (uThreadCount = 0; uThreadCount <= 8; uThreadCount++)
+      SymTable_mapParallel(oSymTable, incrementValue, NULL,
+         uThreadCount);
+   for (i = 0; i < BINDING_COUNT; i++)
+      ASSURE(aiValues[i] == 9);
+
+   /* A thread count far beyond the work to share out is cut down
+      rather than attempted. */
+   SymTable_mapParallel(oSymTable, incrementValue, NULL, (size_t)-1);
+   for (i = 0; i < BINDING_COUNT; i++)
+      ASSURE(aiValues[i] == 10);
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test SymTable_getMany(), with batches of every size up to a few
+   hundred keys, half of them absent. */
+
+static void testGetMany(void)
+{
+   enum {BINDING_COUNT = 5000, KEY_COUNT = 300, MAX_KEY_LENGTH = 10};
+
+   SymTable_T oSymTable;
+   static char aacKeys[KEY_COUNT][MAX_KEY_LENGTH];
+   const char *apcKeys[KEY_COUNT];
+   void *apvValues[KEY_COUNT];
+   static int aiValues[BINDING_COUNT];
+   size_t uCount;
+   size_t uFound;
+   size_t uExpected;
+   int i;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_getMany().\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   /* Nothing is found in an empty table, and no keys is no work. */
+   apcKeys[0] = "Jeter";
+   apvValues[0] = aiValues;
+   ASSURE(SymTable_getMany(oSymTable, apcKeys, 1, apvValues) == 0);
+   ASSURE(apvValues[0] == NULL);
+   ASSURE(SymTable_getMany(oSymTable, apcKeys, 0, apvValues) == 0);
+
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(aacKeys[0], "%d", i);
+      iSuccessful = SymTable_put(oSymTable, aacKeys[0],
+         i == 0 ? NULL : &aiValues[i]);
+      ASSURE(iSuccessful);
+   }
+
+   /* Every other key is bound, the first to NULL. */
+   for (i = 0; i < KEY_COUNT; i++)
+   {
+      if (i % 2 == 0)
+         sprintf(aacKeys[i], "%d", i / 2 * 17);
+      else
+         sprintf(aacKeys[i], "x%d", i);
+      apcKeys[i] = aacKeys[i];
+   }
+   for (uCount = 0; uCount <= KEY_COUNT; uCount++)
+   {
+      uFound = SymTable_getMany(oSymTable, apcKeys, uCount, apvValues);
+      uExpected = (uCount + 1) / 2;
+      ASSURE(uFound == uExpected);
+      for (i = 0; i < (int)uCount; i++)
+         ASSURE(apvValues[i] == SymTable_get(oSymTable, apcKeys[i]));
+   }
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test SymTable_hashKey() and the functions that take its hash codes,
+   resolving keys through a chain of nested scopes the way a compiler
+   would, with each key hashed once for the whole chain. */
+
+static void testHashed(void)
+{
+   enum {SCOPE_COUNT = 10, BINDING_COUNT = 1000, MAX_KEY_LENGTH = 10};
+
+   SymTable_T aoScopes[SCOPE_COUNT];
+   SymTable_Hash oHash;
+   char acKey[MAX_KEY_LENGTH];
+   static int aiValues[BINDING_COUNT];
+   void *pvValue;
+   int iScope;
+   int i;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_hashKey() and its companions.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   /* Scope i binds the keys i, i + SCOPE_COUNT, ..., half of them
+      through SymTable_putHashed and half through SymTable_put. */
+   for (iScope = 0; iScope < SCOPE_COUNT; iScope++)
+   {
+      aoScopes[iScope] = SymTable_new();
+      ASSURE(aoScopes[iScope] != NULL);
+   }
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      if (i % 2 == 0)
+         iSuccessful = SymTable_putHashed(aoScopes[i % SCOPE_COUNT],
+            acKey, SymTable_hashKey(acKey), &aiValues[i]);
+      else
+         iSuccessful = SymTable_put(aoScopes[i % SCOPE_COUNT], acKey,
+            &aiValues[i]);
+      ASSURE(iSuccessful);
+   }
+
+   /* A key already bound is not bound again. */
+   iSuccessful = SymTable_putHashed(aoScopes[0], "0",
+      SymTable_hashKey("0"), NULL);
+   ASSURE(! iSuccessful);
+   ASSURE(SymTable_get(aoScopes[0], "0") == &aiValues[0]);
+
+   /* Each key hashes the same for every scope, and is found in exactly
+      the scope that binds it. */
+   for (i = 0; i < BINDING_COUNT + SCOPE_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      oHash = SymTable_hashKey(acKey);
+      pvValue = NULL;
+      for (iScope = SCOPE_COUNT - 1; iScope >= 0; iScope--)
+      {
+         ASSURE(SymTable_containsHashed(aoScopes[iScope], acKey, oHash)
+            == SymTable_contains(aoScopes[iScope], acKey));
+         if (SymTable_containsHashed(aoScopes[iScope], acKey, oHash))
+            pvValue = SymTable_getHashed(aoScopes[iScope], acKey, oHash);
+      }
+      ASSURE(pvValue == (i < BINDING_COUNT ? &aiValues[i] : NULL));
+   }
+
+   /* Keys differing only in length do not match. */
+   oHash = SymTable_hashKey("1");
+   ASSURE(SymTable_getHashed(aoScopes[1], "1", oHash) == &aiValues[1]);
+   oHash = SymTable_hashKey("11");
+   ASSURE(SymTable_getHashed(aoScopes[1], "11", oHash) == &aiValues[11]);
+   oHash = SymTable_hashKey("");
+   ASSURE(! SymTable_containsHashed(aoScopes[1], "", oHash));
+
+   /* Replacing and removing through a hash act as their plain
+      counterparts do. */
+   oHash = SymTable_hashKey("21");
+   pvValue = SymTable_replaceHashed(aoScopes[1], "21", oHash, &aiValues[0]);
+   ASSURE(pvValue == &aiValues[21]);
+   ASSURE(SymTable_get(aoScopes[1], "21") == &aiValues[0]);
+   pvValue = SymTable_removeHashed(aoScopes[1], "21", oHash);
+   ASSURE(pvValue == &aiValues[0]);
+   ASSURE(! SymTable_contains(aoScopes[1], "21"));
+   ASSURE(SymTable_replaceHashed(aoScopes[1], "21", oHash, &aiValues[21])
+      == NULL);
+   ASSURE(SymTable_removeHashed(aoScopes[1], "21", oHash) == NULL);
+   ASSURE(! SymTable_contains(aoScopes[1], "21"));
+
+   for (iScope = 0; iScope < SCOPE_COUNT; iScope++)
+      SymTable_free(aoScopes[iScope]);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test SymTable_intern() and the functions that take its atoms, with
+   the same atoms bound in many tables at once. */
+
+static void testAtoms(void)
+{
+   enum {TABLE_COUNT = 20, ATOM_COUNT = 500, MAX_KEY_LENGTH = 10};
+
+   SymTable_T aoTables[TABLE_COUNT];
+   const char *apcAtoms[ATOM_COUNT];
+   char acKey[MAX_KEY_LENGTH];
+   static int aiValues[ATOM_COUNT];
+   const char *pcAtom;
+   int iTable;
+   int i;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_intern() and its companions.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   /* Equal keys give the same atom, and an atom interns to itself. */
+   for (i = 0; i < ATOM_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      apcAtoms[i] = SymTable_intern(acKey);
+      ASSURE(apcAtoms[i] != NULL);
+      ASSURE(apcAtoms[i] != acKey);
+      ASSURE(strcmp(apcAtoms[i], acKey) == 0);
+   }
+   for (i = 0; i < ATOM_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTable_intern(acKey) == apcAtoms[i]);
+      ASSURE(SymTable_intern(apcAtoms[i]) == apcAtoms[i]);
+   }
+   pcAtom = SymTable_intern("");
+   ASSURE(pcAtom != NULL && *pcAtom == '\0');
+   ASSURE(SymTable_intern("") == pcAtom);
+
+   /* Table i binds the first i * 25 atoms, every other one through
+      SymTable_put, which copies the key as usual. */
+   for (iTable = 0; iTable < TABLE_COUNT; iTable++)
+   {
+      aoTables[iTable] = SymTable_new();
+      ASSURE(aoTables[iTable] != NULL);
+      for (i = 0; i < iTable * (ATOM_COUNT / TABLE_COUNT); i++)
+      {
+         if (i % 2 == 0)
+            iSuccessful = SymTable_putAtom(aoTables[iTable], apcAtoms[i],
+               &aiValues[i]);
+         else
+            iSuccessful = SymTable_put(aoTables[iTable], apcAtoms[i],
+               &aiValues[i]);
+         ASSURE(iSuccessful);
+      }
+      iSuccessful = SymTable_putAtom(aoTables[iTable], pcAtom, NULL);
+      ASSURE(iSuccessful);
+      iSuccessful = SymTable_putAtom(aoTables[iTable], pcAtom, NULL);
+      ASSURE(! iSuccessful);
+   }
+
+   /* Atoms and plain keys find the same bindings. */
+   for (iTable = 0; iTable < TABLE_COUNT; iTable++)
+   {
+      for (i = 0; i < ATOM_COUNT; i++)
+      {
+         sprintf(acKey, "%d", i);
+         if (i < iTable * (ATOM_COUNT / TABLE_COUNT))
+         {
+            ASSURE(SymTable_getAtom(aoTables[iTable], apcAtoms[i])
+               == &aiValues[i]);
+            ASSURE(SymTable_get(aoTables[iTable], acKey)
+               == &aiValues[i]);
+         }
+         else
+         {
+            ASSURE(! SymTable_containsAtom(aoTables[iTable],
+               apcAtoms[i]));
+            ASSURE(! SymTable_contains(aoTables[iTable], acKey));
+         }
+      }
+      ASSURE(SymTable_containsAtom(aoTables[iTable], pcAtom));
+      ASSURE(SymTable_contains(aoTables[iTable], ""));
+   }
+
+   /* Removing a binding or freeing a table leaves its atoms alone. */
+   ASSURE(SymTable_remove(aoTables[TABLE_COUNT - 1], "0")
+      == &aiValues[0]);
+   ASSURE(! SymTable_containsAtom(aoTables[TABLE_COUNT - 1],
+      apcAtoms[0]));
+   for (iTable = 0; iTable < TABLE_COUNT; iTable++)
+      SymTable_free(aoTables[iTable]);
+   ASSURE(strcmp(apcAtoms[0], "0") == 0);
+   ASSURE(SymTable_intern("0") == apcAtoms[0]);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test SymTable_putBorrowed(), whose bindings point to keys that the
+   caller owns. */
+
+static void testBorrowed(void)
+{
+   enum {BINDING_COUNT = 3000, MAX_KEY_LENGTH = 10};
+
+   SymTable_T oSymTable;
+   SymTable_Iter oIter;
+   static char aacKeys[BINDING_COUNT][MAX_KEY_LENGTH];
+   char acKey[MAX_KEY_LENGTH];
+   static int aiValues[BINDING_COUNT];
+   int *piValue;
+   int i;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_putBorrowed().\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   /* Every other key is borrowed, the rest are copied as usual, and
+      the table grows past its initial size while holding both. */
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      aiValues[i] = i;
+      sprintf(aacKeys[i], "%d", i);
+      if (i % 2 == 0)
+         iSuccessful = SymTable_putBorrowed(oSymTable, aacKeys[i],
+            &aiValues[i]);
+      else
+         iSuccessful = SymTable_put(oSymTable, aacKeys[i], &aiValues[i]);
+      ASSURE(iSuccessful);
+   }
+   ASSURE(SymTable_getLength(oSymTable) == BINDING_COUNT);
+
+   /* A key that is already bound is not bound again, borrowed or not. */
+   iSuccessful = SymTable_putBorrowed(oSymTable, aacKeys[0], NULL);
+   ASSURE(! iSuccessful);
+   sprintf(acKey, "%d", 1);
+   iSuccessful = SymTable_putBorrowed(oSymTable, acKey, NULL);
+   ASSURE(! iSuccessful);
+   ASSURE(SymTable_getLength(oSymTable) == BINDING_COUNT);
+
+   /* Lookups with equal keys from another buffer find every binding,
+      and the table hands back the caller's own key when it borrowed
+      it. */
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTable_get(oSymTable, acKey) == &aiValues[i]);
+   }
+   for (SymTable_iterBegin(oSymTable, &oIter); SymTable_iterNext(&oIter); )
+   {
+      piValue = (int*)SymTable_iterValue(&oIter);
+      if (*piValue % 2 == 0)
+         ASSURE(SymTable_iterKey(&oIter) == aacKeys[*piValue]);
+      else
+         ASSURE(SymTable_iterKey(&oIter) != aacKeys[*piValue]);
+   }
+
+   /* Removing and compacting leave the caller's keys alone. */
+   for (i = 0; i < BINDING_COUNT; i += 4)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTable_remove(oSymTable, acKey) == &aiValues[i]);
+   }
+   SymTable_compact(oSymTable);
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      ASSURE(SymTable_contains(oSymTable, aacKeys[i]) == (i % 4 != 0));
+      sprintf(acKey, "%d", i);
+      ASSURE(strcmp(aacKeys[i], acKey) == 0);
+   }
+   iSuccessful = SymTable_putBorrowed(oSymTable, aacKeys[0], &aiValues[0]);
+   ASSURE(iSuccessful);
+   ASSURE(SymTable_get(oSymTable, "0") == &aiValues[0]);
+   SymTable_free(oSymTable);
+   ASSURE(strcmp(aacKeys[0], "0") == 0);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test SymTable_putN(), SymTable_containsN(), SymTable_getN() and
+   SymTable_removeN(), whose keys are byte ranges that may hold null
+   characters and need not be followed by one. */
+
+static void testKeysN(void)
+{
+   enum {WORD_COUNT = 4};
+
+   static const char acText[] = "alpha beta gamma delta";
+   static const char *apcWords[WORD_COUNT] =
+      {"alpha", "beta", "gamma", "delta"};
+   SymTable_T oSymTable;
+   SymTable_Iter oIter;
+   char *pcExact;
+   int aiValues[WORD_COUNT];
+   int i;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_putN() and its companions.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   /* Slices of a larger buffer are bound without being copied out
+      first, and equal the string keys of the same characters. */
+   for (i = 0; i < WORD_COUNT; i++)
+      aiValues[i] = i;
+   iSuccessful = SymTable_putN(oSymTable, acText, 5, &aiValues[0]);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_putN(oSymTable, acText + 6, 4, &aiValues[1]);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTable, "gamma", &aiValues[2]);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_putN(oSymTable, acText + 17, 5, &aiValues[3]);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_putN(oSymTable, acText + 11, 5, NULL);
+   ASSURE(! iSuccessful);
+   for (i = 0; i < WORD_COUNT; i++)
+   {
+      ASSURE(SymTable_get(oSymTable, apcWords[i]) == &aiValues[i]);
+      ASSURE(SymTable_getN(oSymTable, apcWords[i], strlen(apcWords[i]))
+         == &aiValues[i]);
+   }
+   ASSURE(! SymTable_containsN(oSymTable, acText, 4));
+   ASSURE(! SymTable_containsN(oSymTable, acText, 6));
+   ASSURE(! SymTable_contains(oSymTable, "alph"));
+
+   /* A key that fills its buffer exactly is never read past its end. */
+   pcExact = (char*)malloc(5);
+   ASSURE(pcExact != NULL);
+   memcpy(pcExact, "omega", 5);
+   iSuccessful = SymTable_putN(oSymTable, pcExact, 5, &aiValues[0]);
+   ASSURE(iSuccessful);
+   ASSURE(SymTable_getN(oSymTable, pcExact, 5) == &aiValues[0]);
+   ASSURE(SymTable_removeN(oSymTable, pcExact, 5) == &aiValues[0]);
+   free(pcExact);
+   ASSURE(! SymTable_contains(oSymTable, "omega"));
+
+   /* Null characters are part of the key. */
+   iSuccessful = SymTable_putN(oSymTable, "a\0b", 3, &aiValues[0]);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_putN(oSymTable, "a\0c", 3, &aiValues[1]);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_putN(oSymTable, "a", 1, &aiValues[2]);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_putN(oSymTable, "a\0", 2, &aiValues[3]);
+   ASSURE(iSuccessful);
+   ASSURE(SymTable_getN(oSymTable, "a\0b", 3) == &aiValues[0]);
+   ASSURE(SymTable_getN(oSymTable, "a\0c", 3) == &aiValues[1]);
+   ASSURE(SymTable_get(oSymTable, "a") == &aiValues[2]);
+   ASSURE(SymTable_getN(oSymTable, "a\0", 2) == &aiValues[3]);
+   ASSURE(! SymTable_containsN(oSymTable, "a\0d", 3));
+   ASSURE(SymTable_removeN(oSymTable, "a\0b", 3) == &aiValues[0]);
+   ASSURE(! SymTable_containsN(oSymTable, "a\0b", 3));
+   ASSURE(SymTable_containsN(oSymTable, "a\0c", 3));
+   ASSURE(SymTable_removeN(oSymTable, "a\0b", 3) == NULL);
+
+   /* The iterator gives the full length of every key, of which only
+      "a\0c" and "a\0" run past their first null character. */
+   i = 0;
+   for (SymTable_iterBegin(oSymTable, &oIter); SymTable_iterNext(&oIter); )
+   {
+      if (SymTable_iterKeyLength(&oIter) != strlen(SymTable_iterKey(&oIter)))
+      {
+         ASSURE(SymTable_iterKey(&oIter)[0] == 'a');
+         ASSURE(SymTable_iterKey(&oIter)[1] == '\0');
+         i++;
+      }
+   }
+   ASSURE(i == 2);
+
+   /* The empty key can be given either way. */
+   iSuccessful = SymTable_putN(oSymTable, acText, 0, &aiValues[0]);
+   ASSURE(iSuccessful);
+   ASSURE(SymTable_get(oSymTable, "") == &aiValues[0]);
+   ASSURE(SymTable_remove(oSymTable, "") == &aiValues[0]);
+   ASSURE(SymTable_getLength(oSymTable) == WORD_COUNT + 3);
+   SymTable_free(oSymTable);
+
+   /* A prefix of a borrowed key is a different key, even though it
+      starts at the same address. */
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   iSuccessful = SymTable_putBorrowed(oSymTable, apcWords[0], &aiValues[0]);
+   ASSURE(iSuccessful);
+   ASSURE(SymTable_getN(oSymTable, apcWords[0], 5) == &aiValues[0]);
+   ASSURE(! SymTable_containsN(oSymTable, apcWords[0], 4));
+   ASSURE(SymTable_removeN(oSymTable, apcWords[0], 4) == NULL);
+   ASSURE(SymTable_getLength(oSymTable) == 1);
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test a SymTable object created by SymTable_newWithAllocator(),
+   whose every block must go back to its allocator with the size it
+   was allocated with. */
+
+static void testAllocator(void)
+{
+   enum {BINDING_COUNT = 2000, MAX_KEY_LENGTH = 10, MAX_BUDGET = 40};
+
+   struct Counter oCounter;
+   SymTable_Allocator oAllocator;
+   SymTable_T oSymTable;
+   SymTable_Iter oIter;
+   static char aacKeys[BINDING_COUNT][MAX_KEY_LENGTH];
+   static int aiValues[BINDING_COUNT];
+   int iDivisor;
+   int iBound;
+   int i;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_newWithAllocator().\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oCounter.lBlocks = 0;
+   oCounter.uBytes = 0;
+   oCounter.lBudget = -1;
+   oAllocator.pfAlloc = countingAlloc;
+   oAllocator.pfFree = countingFree;
+   oAllocator.pvContext = &oCounter;
+
+   /* Every way of adding and removing bindings goes through the
+      allocator, and freeing the table gives back all of it. */
+   oSymTable = SymTable_newWithAllocator(&oAllocator);
+   ASSURE(oSymTable != NULL);
+   ASSURE(oCounter.lBlocks > 0);
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      aiValues[i] = i;
+      sprintf(aacKeys[i], "%d", i);
+      if (i % 3 == 0)
+         iSuccessful = SymTable_put(oSymTable, aacKeys[i], &aiValues[i]);
+      else if (i % 3 == 1)
+         iSuccessful = SymTable_putBorrowed(oSymTable, aacKeys[i],
+            &aiValues[i]);
+      else
+         iSuccessful = SymTable_putN(oSymTable, aacKeys[i],
+            strlen(aacKeys[i]), &aiValues[i]);
+      ASSURE(iSuccessful);
+   }
+   ASSURE(SymTable_getOrPut(oSymTable, "extra", &aiValues[0]) != NULL);
+   ASSURE(oCounter.uBytes > BINDING_COUNT * sizeof(void*));
+   for (i = 0; i < BINDING_COUNT; i += 2)
+      ASSURE(SymTable_remove(oSymTable, aacKeys[i]) == &aiValues[i]);
+   iDivisor = 3;
+   (void)SymTable_removeIf(oSymTable, isMultiple, &iDivisor, NULL);
+   for (SymTable_iterBegin(oSymTable, &oIter); SymTable_iterNext(&oIter); )
+      if (*(int*)SymTable_iterValue(&oIter) % 5 == 0)
+         SymTable_iterRemoveCurrent(&oIter);
+   SymTable_compact(oSymTable);
+   for (i = 0; i < BINDING_COUNT; i++)
+      ASSURE(SymTable_contains(oSymTable, aacKeys[i])
+         == (i % 2 != 0 && i % 3 != 0 && i % 5 != 0));
+   SymTable_free(oSymTable);
+   ASSURE(oCounter.lBlocks == 0);
+   ASSURE(oCounter.uBytes == 0);
+
+   /* When the allocator runs dry, puts fail cleanly, the table keeps
+      every binding it already had, and nothing leaks. */
+   for (oCounter.lBudget = 0; oCounter.lBudget < MAX_BUDGET; )
+   {
+      i = (int)oCounter.lBudget;
+      oSymTable = SymTable_newWithAllocator(&oAllocator);
+      if (oSymTable != NULL)
+      {
+         iBound = 0;
+         while (iBound < BINDING_COUNT
+            && SymTable_put(oSymTable, aacKeys[iBound], &aiValues[iBound]))
+            iBound++;
+         ASSURE(iBound < BINDING_COUNT);
+         ASSURE(SymTable_getLength(oSymTable) == (size_t)iBound);
+         ASSURE(! SymTable_putN(oSymTable, aacKeys[iBound],
+            strlen(aacKeys[iBound]), NULL));
+         for (; iBound > 0; iBound--)
+            ASSURE(SymTable_get(oSymTable, aacKeys[iBound - 1])
+               == &aiValues[iBound - 1]);
+         SymTable_free(oSymTable);
+      }
+      ASSURE(oCounter.lBlocks == 0);
+      oCounter.lBudget = i + 1;
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test SymTable_getStats(). The shape of a table depends on the
+   implementation, so only what holds for all of them is checked. */
+
+static void testStats(void)
+{
+   enum {BINDING_COUNT = 3000, MAX_KEY_LENGTH = 10};
+
+   SymTable_T oSymTable;
+   SymTable_Stats oStats;
+   static char aacKeys[BINDING_COUNT][MAX_KEY_LENGTH];
+   static int aiValues[BINDING_COUNT];
+   size_t uKeyBytes = 0;
+   size_t uExpansions;
+   size_t uHistogramTotal;
+   int i;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_getStats().\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   SymTable_getStats(oSymTable, &oStats);
+   ASSURE(oStats.uLength == 0);
+   ASSURE(oStats.uBucketCount > 0);
+   ASSURE(oStats.dLoadFactor == 0.0);
+   ASSURE(oStats.uMaxChain == 0);
+   ASSURE(oStats.dAvgChain == 0.0);
+   ASSURE(oStats.dAvgProbe == 0.0);
+   ASSURE(oStats.uExpansions == 0);
+   ASSURE(oStats.uTableBytes > 0);
+   ASSURE(oStats.uNodeBytes == 0);
+   ASSURE(oStats.uKeyBytes == 0);
+
+   /* Every copied key is counted once, and borrowed keys not at all. */
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      aiValues[i] = i;
+      sprintf(aacKeys[i], "%d", i);
+      if (i % 4 == 0)
+         iSuccessful = SymTable_putBorrowed(oSymTable, aacKeys[i],
+            &aiValues[i]);
+      else
+      {
+         iSuccessful = SymTable_put(oSymTable, aacKeys[i], &aiValues[i]);
+         uKeyBytes += strlen(aacKeys[i]) + 1;
+      }
+      ASSURE(iSuccessful);
+   }
+   SymTable_getStats(oSymTable, &oStats);
+   ASSURE(oStats.uLength == BINDING_COUNT);
+   ASSURE(oStats.dLoadFactor
+      == (double)BINDING_COUNT / (double)oStats.uBucketCount);
+   ASSURE(oStats.uMaxChain >= 1);
+   ASSURE(oStats.uMaxChain <= BINDING_COUNT);
+   ASSURE(oStats.dAvgChain >= 1.0);
+   ASSURE(oStats.dAvgChain <= (double)oStats.uMaxChain);
+   ASSURE(oStats.dAvgProbe >= 1.0);
+   ASSURE(oStats.dAvgProbe <= (double)oStats.uMaxChain);
+   uHistogramTotal = 0;
+   for (i = 0; i < SYMTABLE_STATS_HISTOGRAM_SIZE; i++)
+      uHistogramTotal += oStats.auChainHistogram[i];
+   ASSURE(uHistogramTotal > 0);
+   ASSURE(oStats.uExpansions > 0 || oStats.uBucketCount == 1);
+   ASSURE(oStats.uKeyBytes == uKeyBytes);
+   ASSURE(oStats.uNodeBytes > 0 || oStats.uBucketBytes > 0);
+
+   /* Lookups change nothing, and the counts follow removals. */
+   uExpansions = oStats.uExpansions;
+   for (i = 0; i < BINDING_COUNT; i++)
+      ASSURE(SymTable_get(oSymTable, aacKeys[i]) == &aiValues[i]);
+   for (i = 0; i < BINDING_COUNT; i++)
+      if (i % 2 != 0)
+      {
+         ASSURE(SymTable_remove(oSymTable, aacKeys[i]) == &aiValues[i]);
+         uKeyBytes -= strlen(aacKeys[i]) + 1;
+      }
+   SymTable_getStats(oSymTable, &oStats);
+   ASSURE(oStats.uLength == BINDING_COUNT / 2);
+   ASSURE(oStats.uExpansions == uExpansions);
+   ASSURE(oStats.uKeyBytes == uKeyBytes);
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test a SymTable object created by SymTable_newArena(), whose
+   removed bindings are recycled by later puts. */
+
+static void testArena(void)
+{
+   enum {BINDING_COUNT = 1000, KEY_SIZE = 1000};
+
+   SymTable_T oSymTable;
+   char acKey[KEY_SIZE];
+   char acLongKey[KEY_SIZE];
+   char acShortstop[] = "Shortstop";
+   char *pcValue;
+   int i;
+   int iSuccessful;
+   size_t uLength;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing a SymTable object created by SymTable_newArena().\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_newArena();
+   ASSURE(oSymTable != NULL);
+
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, acShortstop);
+      ASSURE(iSuccessful);
+   }
+
+   /* Remove the even keys, then put them back. */
+   for (i = 0; i < BINDING_COUNT; i += 2)
+   {
+      sprintf(acKey, "%d", i);
+      pcValue = (char*)SymTable_remove(oSymTable, acKey);
+      ASSURE(pcValue == acShortstop);
+   }
+   uLength = SymTable_getLength(oSymTable);
+   ASSURE(uLength == BINDING_COUNT / 2);
+   for (i = 0; i < BINDING_COUNT; i += 2)
+   {
+      sprintf(acKey, "%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, acKey);
+      ASSURE(iSuccessful);
+   }
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      pcValue = (char*)SymTable_get(oSymTable, acKey);
+      ASSURE(pcValue == ((i % 2 == 0) ? acKey : acShortstop));
+   }
+
+   /* Keys too long to share a slab with other bindings. */
+   for (i = 0; i < KEY_SIZE - 1; i++)
+      acLongKey[i] = 'a';
+   acLongKey[KEY_SIZE - 1] = '\0';
+   iSuccessful = SymTable_put(oSymTable, acLongKey, acShortstop);
+   ASSURE(iSuccessful);
+   acLongKey[0] = 'b';
+   iSuccessful = SymTable_put(oSymTable, acLongKey, acShortstop);
+   ASSURE(iSuccessful);
+   pcValue = (char*)SymTable_remove(oSymTable, acLongKey);
+   ASSURE(pcValue == acShortstop);
+   acLongKey[0] = 'a';
+   pcValue = (char*)SymTable_get(oSymTable, acLongKey);
+   ASSURE(pcValue == acShortstop);
+
+   uLength = SymTable_getLength(oSymTable);
+   ASSURE(uLength == BINDING_COUNT + 1);
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
 /* Test the ability of a SymTable object to be large, that is, to
    contain iBindingCount bindings. Write the time consumed to stdout. */
 
@@ -912,6 +2131,10 @@ static void testLargeTable(int iBindingCount)
    iFinalClock = clock();
    printf("CPU time (%d bindings):  %f seconds\n", iBindingCount,
       ((double)(iFinalClock - iInitialClock)) / CLOCKS_PER_SEC);
+   if (iBindingCount > 0)
+      printf("CPU time per binding:  %f microseconds\n",
+         ((double)(iFinalClock - iInitialClock)) * 1000000.0
+         / CLOCKS_PER_SEC / iBindingCount);
    fflush(stdout);
 }
 
@@ -960,6 +2183,20 @@ int main(int argc, char *argv[])
    testLongKey();
    testTableOfTables();
    testCollisions();
+   testGetOrPut();
+   testArena();
+   testCapacity();
+   testCompact();
+   testIterator();
+   testRemoveIf();
+   testMapParallel();
+   testGetMany();
+   testHashed();
+   testAtoms();
+   testBorrowed();
+   testKeysN();
+   testAllocator();
+   testStats();
    testLargeTable(iBindingCount);
 
    printf("------------------------------------------------------\n");
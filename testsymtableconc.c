@@ -0,0 +1,427 @@
+/*--------------------------------------------------------------------*/
+/* testsymtableconc.c                                                 */
+/* Tests for the concurrent symbol table of symtableconc.c, in the    */
+/* style of testsymtable.c.                                           */
+/*--------------------------------------------------------------------*/
+
+#include "symtableconc.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <string.h>
+#include <assert.h>
+#include <pthread.h>
+
+/*--------------------------------------------------------------------*/
+
+#define ASSURE(i) assure(i, __LINE__)
+
+/*--------------------------------------------------------------------*/
+
+/* If !iSuccessful, print a message to stdout indicating that the
+   test at line iLineNum failed. */
+
+static void assure(int iSuccessful, int iLineNum)
+{
+   if (! iSuccessful)
+   {
+      printf("Test at line %d failed.\n", iLineNum);
+      fflush(stdout);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* The work of one thread of a concurrent test. */
+
+struct Work
+{
+   /* The table under test. */
+   SymTableConc_T oSymTable;
+
+   /* The number of this thread. */
+   int iThread;
+
+   /* The number of bindings each thread works with. */
+   int iBindingCount;
+
+   /* The values of the bindings that stay in the table throughout. */
+   int *piStable;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Count the binding whose key is pcKey in the int pointed to by
+   pvExtra. pvValue is unused. */
+
+static void countBinding(const char *pcKey, void *pvValue,
+   void *pvExtra)
+{
+   assert(pcKey != NULL);
+   assert(pvExtra != NULL);
+
+   (void)pvValue;
+   (*(int*)pvExtra)++;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the most basic SymTableConc functions on one thread. */
+
+static void testBasics(void)
+{
+   SymTableConc_T oSymTable;
+   char acJeter[] = "Jeter";
+   char acMantle[] = "Mantle";
+   char acShortstop[] = "Shortstop";
+   char acCenterField[] = "Center Field";
+   char *pcValue;
+   int iSuccessful;
+   int iCount;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the basic SymTableConc functions.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTableConc_new();
+   ASSURE(oSymTable != NULL);
+   ASSURE(SymTableConc_getLength(oSymTable) == 0);
+
+   iSuccessful = SymTableConc_put(oSymTable, acJeter, acShortstop);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTableConc_put(oSymTable, acMantle, acCenterField);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTableConc_put(oSymTable, acJeter, acCenterField);
+   ASSURE(! iSuccessful);
+   ASSURE(SymTableConc_getLength(oSymTable) == 2);
+
+   ASSURE(SymTableConc_contains(oSymTable, "Jeter"));
+   ASSURE(! SymTableConc_contains(oSymTable, "Ruth"));
+   pcValue = (char*)SymTableConc_get(oSymTable, "Mantle");
+   ASSURE(pcValue == acCenterField);
+   pcValue = (char*)SymTableConc_get(oSymTable, "Ruth");
+   ASSURE(pcValue == NULL);
+
+   pcValue = (char*)SymTableConc_replace(oSymTable, "Mantle",
+      acShortstop);
+   ASSURE(pcValue == acCenterField);
+   pcValue = (char*)SymTableConc_replace(oSymTable, "Ruth",
+      acShortstop);
+   ASSURE(pcValue == NULL);
+   pcValue = (char*)SymTableConc_get(oSymTable, "Mantle");
+   ASSURE(pcValue == acShortstop);
+
+   iCount = 0;
+   SymTableConc_map(oSymTable, countBinding, &iCount);
+   ASSURE(iCount == 2);
+
+   pcValue = (char*)SymTableConc_remove(oSymTable, "Jeter");
+   ASSURE(pcValue == acShortstop);
+   pcValue = (char*)SymTableConc_remove(oSymTable, "Jeter");
+   ASSURE(pcValue == NULL);
+   ASSURE(SymTableConc_getLength(oSymTable) == 1);
+   ASSURE(! SymTableConc_contains(oSymTable, "Jeter"));
+
+   SymTableConc_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Put, check and remove the bindings of the thread described by
+   pvWork, whose keys no other thread uses, twice over. */
+
+static void *writeBindings(void *pvWork)
+{
+   enum {MAX_KEY_LENGTH = 24};
+
+   struct Work *psWork = (struct Work*)pvWork;
+   char acKey[MAX_KEY_LENGTH];
+   int iRound;
+   int i;
+   int iSuccessful;
+
+   for (iRound = 0; iRound < 2; iRound++)
+   {
+      for (i = 0; i < psWork->iBindingCount; i++)
+      {
+         sprintf(acKey, "w%d.%d", psWork->iThread, i);
+         iSuccessful = SymTableConc_put(psWork->oSymTable, acKey,
+            &psWork->piStable[i]);
+         ASSURE(iSuccessful);
+      }
+      for (i = 0; i < psWork->iBindingCount; i++)
+      {
+         sprintf(acKey, "w%d.%d", psWork->iThread, i);
+         ASSURE(SymTableConc_get(psWork->oSymTable, acKey)
+            == &psWork->piStable[i]);
+      }
+      for (i = 0; i < psWork->iBindingCount; i += 2)
+      {
+         sprintf(acKey, "w%d.%d", psWork->iThread, i);
+         ASSURE(SymTableConc_remove(psWork->oSymTable, acKey)
+            == &psWork->piStable[i]);
+      }
+      for (i = 1; i < psWork->iBindingCount; i += 2)
+      {
+         sprintf(acKey, "w%d.%d", psWork->iThread, i);
+         ASSURE(SymTableConc_remove(psWork->oSymTable, acKey)
+            == &psWork->piStable[i]);
+      }
+   }
+   return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Look up the stable bindings of the table described by pvWork
+   READ_ROUNDS times, as many passes as a writer makes over its own
+   bindings, so that the readers do a fixed amount of work rather than
+   spin until the writers are done. Every lookup must succeed, however
+   the writers change the rest of the table. */
+
+static void *readBindings(void *pvWork)
+{
+   enum {MAX_KEY_LENGTH = 24, READ_ROUNDS = 8};
+
+   struct Work *psWork = (struct Work*)pvWork;
+   char acKey[MAX_KEY_LENGTH];
+   int iRound;
+   int i;
+
+   for (iRound = 0; iRound < READ_ROUNDS; iRound++)
+   {
+      for (i = 0; i < psWork->iBindingCount; i++)
+      {
+         sprintf(acKey, "s%d", i);
+         ASSURE(SymTableConc_get(psWork->oSymTable, acKey)
+            == &psWork->piStable[i]);
+      }
+   }
+   return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Replace the values of the stable bindings of the table described by
+   pvWork REPLACE_ROUNDS times, alternating between piStable and the
+   array just after it, while another thread grows the table. Each
+   replace must return the value the previous one stored, which it
+   would not if a replace landing in the middle of an expansion were
+   lost. */
+
+static void *replaceBindings(void *pvWork)
+{
+   enum {MAX_KEY_LENGTH = 24, REPLACE_ROUNDS = 16};
+
+   struct Work *psWork = (struct Work*)pvWork;
+   char acKey[MAX_KEY_LENGTH];
+   int *piOld;
+   int *piNew;
+   int iRound;
+   int i;
+
+   for (iRound = 1; iRound <= REPLACE_ROUNDS; iRound++)
+   {
+      piOld = psWork->piStable
+         + (iRound % 2 == 1 ? 0 : psWork->iBindingCount);
+      piNew = psWork->piStable
+         + (iRound % 2 == 1 ? psWork->iBindingCount : 0);
+      for (i = 0; i < psWork->iBindingCount; i++)
+      {
+         sprintf(acKey, "r%d", i);
+         ASSURE(SymTableConc_replace(psWork->oSymTable, acKey,
+            &piNew[i]) == &piOld[i]);
+      }
+   }
+   return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test replacing values while the table expands: one thread replaces
+   the values of BINDING_COUNT bindings over and over while another
+   adds GROW_COUNT bindings, enough for several expansions. */
+
+static void testReplaceDuringExpansion(void)
+{
+   enum {BINDING_COUNT = 1000, GROW_COUNT = 40000,
+      MAX_KEY_LENGTH = 24};
+
+   SymTableConc_T oSymTable;
+   pthread_t sReplacer;
+   struct Work sWork;
+   static int aiValues[2 * BINDING_COUNT];
+   char acKey[MAX_KEY_LENGTH];
+   int i;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing replacing values during expansions.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTableConc_new();
+   ASSURE(oSymTable != NULL);
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "r%d", i);
+      iSuccessful = SymTableConc_put(oSymTable, acKey, &aiValues[i]);
+      ASSURE(iSuccessful);
+   }
+
+   sWork.oSymTable = oSymTable;
+   sWork.iThread = 0;
+   sWork.iBindingCount = BINDING_COUNT;
+   sWork.piStable = aiValues;
+   iSuccessful = pthread_create(&sReplacer, NULL, replaceBindings,
+      &sWork) == 0;
+   ASSURE(iSuccessful);
+   for (i = 0; i < GROW_COUNT; i++)
+   {
+      sprintf(acKey, "g%d", i);
+      iSuccessful = SymTableConc_put(oSymTable, acKey, &aiValues[0]);
+      ASSURE(iSuccessful);
+   }
+   pthread_join(sReplacer, NULL);
+
+   /* The replacer made an even number of rounds, so every binding is
+      back to its first value. */
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "r%d", i);
+      ASSURE(SymTableConc_get(oSymTable, acKey) == &aiValues[i]);
+   }
+   ASSURE(SymTableConc_getLength(oSymTable)
+      == (size_t)(BINDING_COUNT + GROW_COUNT));
+
+   SymTableConc_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test iThreadCount writer threads and as many reader threads sharing
+   one table, each writer with iBindingCount bindings of its own, while
+   the readers look up iBindingCount bindings that stay put. */
+
+static void testThreads(int iThreadCount, int iBindingCount)
+{
+   enum {MAX_KEY_LENGTH = 24};
+
+   SymTableConc_T oSymTable;
+   pthread_t *psWriters;
+   pthread_t *psReaders;
+   struct Work *psWriterWork;
+   struct Work sReaderWork;
+   char acKey[MAX_KEY_LENGTH];
+   int *piStable;
+   int iCount;
+   int i;
+   int iSuccessful;
+   clock_t iInitialClock;
+   clock_t iFinalClock;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing %d writer and %d reader threads.\n", iThreadCount,
+      iThreadCount);
+   printf("No output except CPU time consumed should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTableConc_new();
+   ASSURE(oSymTable != NULL);
+   psWriters = (pthread_t*)malloc(iThreadCount * sizeof(pthread_t));
+   psReaders = (pthread_t*)malloc(iThreadCount * sizeof(pthread_t));
+   psWriterWork = (struct Work*)malloc(iThreadCount
+      * sizeof(struct Work));
+   piStable = (int*)malloc((iBindingCount + 1) * sizeof(int));
+   ASSURE(psWriters != NULL && psReaders != NULL
+      && psWriterWork != NULL && piStable != NULL);
+
+   for (i = 0; i < iBindingCount; i++)
+   {
+      piStable[i] = i;
+      sprintf(acKey, "s%d", i);
+      iSuccessful = SymTableConc_put(oSymTable, acKey, &piStable[i]);
+      ASSURE(iSuccessful);
+   }
+
+   iInitialClock = clock();
+
+   sReaderWork.oSymTable = oSymTable;
+   sReaderWork.iThread = -1;
+   sReaderWork.iBindingCount = iBindingCount;
+   sReaderWork.piStable = piStable;
+   for (i = 0; i < iThreadCount; i++)
+   {
+      psWriterWork[i] = sReaderWork;
+      psWriterWork[i].iThread = i;
+      iSuccessful = pthread_create(&psReaders[i], NULL, readBindings,
+         &sReaderWork) == 0;
+      ASSURE(iSuccessful);
+      iSuccessful = pthread_create(&psWriters[i], NULL, writeBindings,
+         &psWriterWork[i]) == 0;
+      ASSURE(iSuccessful);
+   }
+   for (i = 0; i < iThreadCount; i++)
+   {
+      pthread_join(psWriters[i], NULL);
+      pthread_join(psReaders[i], NULL);
+   }
+
+   iFinalClock = clock();
+
+   /* Only the stable bindings are left. */
+   ASSURE(SymTableConc_getLength(oSymTable) == (size_t)iBindingCount);
+   iCount = 0;
+   SymTableConc_map(oSymTable, countBinding, &iCount);
+   ASSURE(iCount == iBindingCount);
+
+   SymTableConc_free(oSymTable);
+   free(piStable);
+   free(psWriterWork);
+   free(psReaders);
+   free(psWriters);
+
+   printf("CPU time (%d threads, %d bindings): %f seconds\n",
+      2 * iThreadCount, iBindingCount,
+      ((double)(iFinalClock - iInitialClock)) / CLOCKS_PER_SEC);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the SymTableConc ADT. The first command-line argument is the
+   number of bindings each thread works with, and the second the
+   number of writer threads. Return 0. */
+
+int main(int argc, char *argv[])
+{
+   int iBindingCount;
+   int iThreadCount;
+
+   if (argc != 3)
+   {
+      fprintf(stderr, "Usage: %s bindingcount threadcount\n", argv[0]);
+      exit(EXIT_FAILURE);
+   }
+
+   if (sscanf(argv[1], "%d", &iBindingCount) != 1
+      || sscanf(argv[2], "%d", &iThreadCount) != 1)
+   {
+      fprintf(stderr, "bindingcount and threadcount must be numeric\n");
+      exit(EXIT_FAILURE);
+   }
+   if (iBindingCount < 0 || iThreadCount < 1)
+   {
+      fprintf(stderr, "bindingcount cannot be negative and "
+         "threadcount must be positive\n");
+      exit(EXIT_FAILURE);
+   }
+
+   testBasics();
+   testReplaceDuringExpansion();
+   testThreads(iThreadCount, iBindingCount);
+
+   printf("------------------------------------------------------\n");
+   printf("End of %s.\n", argv[0]);
+   return 0;
+}
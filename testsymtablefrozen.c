@@ -0,0 +1,509 @@
+/*--------------------------------------------------------------------*/
+/* testsymtablefrozen.c                                               */
+/* Tests for the frozen symbol tables of symtablefrozen.c, in the     */
+/* style of testsymtable.c.                                           */
+/*--------------------------------------------------------------------*/
+
+#include "symtablefrozen.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <string.h>
+#include <assert.h>
+#include <stdint.h>
+
+/*--------------------------------------------------------------------*/
+
+#define ASSURE(i) assure(i, __LINE__)
+
+/* The file the tests save tables to. */
+#define FILENAME "testsymtablefrozen.tmp"
+
+/*--------------------------------------------------------------------*/
+
+/* If !iSuccessful, print a message to stdout indicating that the
+   test at line iLineNum failed. */
+
+static void assure(int iSuccessful, int iLineNum)
+{
+   if (! iSuccessful)
+   {
+      printf("Test at line %d failed.\n", iLineNum);
+      fflush(stdout);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Check that the binding whose key is pcKey and whose value is pvValue
+   is also in the SymTable_T pointed to by pvExtra. */
+
+static void checkBinding(const char *pcKey, void *pvValue,
+   void *pvExtra)
+{
+   assert(pcKey != NULL);
+   assert(pvExtra != NULL);
+
+   ASSURE(SymTable_get((SymTable_T)pvExtra, pcKey) == pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the int pointed to by pvValue as the payload to save for the
+   binding whose key is pcKey, or 0 if pvValue is NULL. pvExtra is
+   unused. */
+
+static uint64_t encodeInt(const char *pcKey, void *pvValue,
+   void *pvExtra)
+{
+   assert(pcKey != NULL);
+
+   (void)pvExtra;
+   if (pvValue == NULL)
+      return 0;
+   return (uint64_t)*(int*)pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Check that the binding whose key is pcKey and whose payload is
+   pvValue was saved from the SymTable_T pointed to by pvExtra. */
+
+static void checkPayload(const char *pcKey, void *pvValue,
+   void *pvExtra)
+{
+   assert(pcKey != NULL);
+   assert(pvExtra != NULL);
+
+   ASSURE((uintptr_t)pvValue
+      == (uintptr_t)*(int*)SymTable_get((SymTable_T)pvExtra, pcKey));
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test freezing small tables. */
+
+static void testBasics(void)
+{
+   SymTable_T oSymTable;
+   SymTableFrozen_T oFrozen;
+   char acJeter[] = "Jeter";
+   char acShortstop[] = "Shortstop";
+   char acCenterField[] = "Center Field";
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the basic SymTableFrozen functions.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   /* An empty table. */
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   oFrozen = SymTable_freeze(oSymTable);
+   ASSURE(oFrozen != NULL);
+   ASSURE(SymTableFrozen_getLength(oFrozen) == 0);
+   ASSURE(! SymTableFrozen_contains(oFrozen, "Jeter"));
+   ASSURE(SymTableFrozen_get(oFrozen, "Jeter") == NULL);
+   SymTableFrozen_map(oFrozen, checkBinding, oSymTable);
+   SymTableFrozen_free(oFrozen);
+
+   /* A table with a few bindings, one with a NULL value and one with
+      an empty key. */
+   iSuccessful = SymTable_put(oSymTable, acJeter, acShortstop);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTable, "Mantle", acCenterField);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTable, "Ruth", NULL);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTable, "", acShortstop);
+   ASSURE(iSuccessful);
+   oFrozen = SymTable_freeze(oSymTable);
+   ASSURE(oFrozen != NULL);
+
+   /* The frozen table owns its keys and keeps its bindings after the
+      original table changes. */
+   strcpy(acJeter, "Xeter");
+   SymTable_remove(oSymTable, "Mantle");
+   ASSURE(SymTableFrozen_getLength(oFrozen) == 4);
+   ASSURE(SymTableFrozen_get(oFrozen, "Jeter") == acShortstop);
+   ASSURE(SymTableFrozen_get(oFrozen, "Mantle") == acCenterField);
+   ASSURE(SymTableFrozen_contains(oFrozen, "Ruth"));
+   ASSURE(SymTableFrozen_get(oFrozen, "Ruth") == NULL);
+   ASSURE(SymTableFrozen_get(oFrozen, "") == acShortstop);
+   ASSURE(! SymTableFrozen_contains(oFrozen, "Xeter"));
+   ASSURE(! SymTableFrozen_contains(oFrozen, "Jete"));
+   ASSURE(! SymTableFrozen_contains(oFrozen, "Jeterr"));
+   SymTable_free(oSymTable);
+   SymTableFrozen_free(oFrozen);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test freezing tables whose keys, added by SymTable_putN(), hold
+   null characters. */
+
+static void testBinaryKeys(void)
+{
+   SymTable_T oSymTable;
+   SymTableFrozen_T oFrozen;
+   int aiValues[] = {0, 1, 2};
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_freeze with binary keys.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   /* A key is not cut short at its first null character, so keys that
+      differ only past it stay apart. */
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   iSuccessful = SymTable_putN(oSymTable, "a\0b", 3, &aiValues[0]);
+   ASSURE(iSuccessful);
+   oFrozen = SymTable_freeze(oSymTable);
+   ASSURE(oFrozen != NULL);
+   ASSURE(! SymTableFrozen_contains(oFrozen, "a"));
+   ASSURE(SymTableFrozen_getN(oFrozen, "a\0b", 3) == &aiValues[0]);
+   SymTableFrozen_free(oFrozen);
+
+   iSuccessful = SymTable_putN(oSymTable, "a\0c", 3, &aiValues[1]);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTable, "a", &aiValues[2]);
+   ASSURE(iSuccessful);
+   oFrozen = SymTable_freeze(oSymTable);
+   ASSURE(oFrozen != NULL);
+   ASSURE(SymTableFrozen_getLength(oFrozen) == 3);
+   ASSURE(SymTableFrozen_getN(oFrozen, "a\0b", 3) == &aiValues[0]);
+   ASSURE(SymTableFrozen_getN(oFrozen, "a\0c", 3) == &aiValues[1]);
+   ASSURE(SymTableFrozen_get(oFrozen, "a") == &aiValues[2]);
+   ASSURE(SymTableFrozen_getN(oFrozen, "a", 1) == &aiValues[2]);
+   ASSURE(SymTableFrozen_containsN(oFrozen, "a\0c", 3));
+   ASSURE(! SymTableFrozen_containsN(oFrozen, "a\0", 2));
+   ASSURE(! SymTableFrozen_containsN(oFrozen, "a\0d", 3));
+
+   /* The full keys survive a save and a map. */
+   iSuccessful = SymTableFrozen_save(oFrozen, FILENAME, encodeInt,
+      NULL);
+   ASSURE(iSuccessful);
+   SymTableFrozen_free(oFrozen);
+   oFrozen = SymTable_openMapped(FILENAME);
+   ASSURE(oFrozen != NULL);
+   ASSURE((uintptr_t)SymTableFrozen_getN(oFrozen, "a\0b", 3) == 0);
+   ASSURE(SymTableFrozen_containsN(oFrozen, "a\0b", 3));
+   ASSURE((uintptr_t)SymTableFrozen_getN(oFrozen, "a\0c", 3) == 1);
+   ASSURE((uintptr_t)SymTableFrozen_get(oFrozen, "a") == 2);
+   SymTableFrozen_free(oFrozen);
+
+   remove(FILENAME);
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Freeze oSymTable and check that the snapshot holds its
+   iBindingCount bindings, keyed "0" upward, while oSymTable itself,
+   which might have a rehash pending or room reserved, keeps the
+   shape it had. */
+
+static void checkFreezeLeavesTable(SymTable_T oSymTable,
+   int iBindingCount)
+{
+   enum {MAX_KEY_LENGTH = 16};
+
+   SymTableFrozen_T oFrozen;
+   SymTable_Stats oBefore;
+   SymTable_Stats oAfter;
+   char acKey[MAX_KEY_LENGTH];
+   int i;
+
+   SymTable_getStats(oSymTable, &oBefore);
+   oFrozen = SymTable_freeze(oSymTable);
+   ASSURE(oFrozen != NULL);
+   SymTable_getStats(oSymTable, &oAfter);
+   ASSURE(oAfter.uBucketCount == oBefore.uBucketCount);
+   ASSURE(oAfter.uBucketBytes == oBefore.uBucketBytes);
+   ASSURE(oAfter.uExpansions == oBefore.uExpansions);
+   ASSURE(SymTableFrozen_getLength(oFrozen) == (size_t)iBindingCount);
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTableFrozen_get(oFrozen, acKey)
+         == SymTable_get(oSymTable, acKey));
+   }
+   SymTableFrozen_free(oFrozen);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test that freezing a table only reads it, so that other threads
+   may go on reading the table meanwhile. */
+
+static void testSourceUnchanged(void)
+{
+   enum {BINDING_COUNT = 1000, RESERVED = 100000, MAX_KEY_LENGTH = 16};
+
+   SymTable_T oSymTable;
+   SymTable_Stats oStats;
+   char acKey[MAX_KEY_LENGTH];
+   static int aiValues[BINDING_COUNT];
+   int i;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing that SymTable_freeze leaves its table unchanged.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   /* A table that has just expanded, and so may have an incremental
+      rehash pending. */
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   SymTable_getStats(oSymTable, &oStats);
+   i = 0;
+   do
+   {
+      sprintf(acKey, "%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, &aiValues[i]);
+      ASSURE(iSuccessful);
+      i++;
+      SymTable_getStats(oSymTable, &oStats);
+   } while (oStats.uExpansions < 2 && i < BINDING_COUNT);
+   checkFreezeLeavesTable(oSymTable, i);
+   SymTable_free(oSymTable);
+
+   /* A table with far more room reserved than it uses. */
+   oSymTable = SymTable_newWithCapacity(RESERVED);
+   ASSURE(oSymTable != NULL);
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, &aiValues[i]);
+      ASSURE(iSuccessful);
+   }
+   checkFreezeLeavesTable(oSymTable, BINDING_COUNT);
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test saving tables to files and mapping them back. */
+
+static void testSave(void)
+{
+   SymTable_T oSymTable;
+   SymTable_T oSymTable2;
+   SymTableFrozen_T oFrozen;
+   FILE *psFile;
+   int aiValues[] = {7, 0, 42};
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_save and SymTable_openMapped.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   /* An empty table. */
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   iSuccessful = SymTable_save(oSymTable, FILENAME, encodeInt, NULL);
+   ASSURE(iSuccessful);
+   oFrozen = SymTable_openMapped(FILENAME);
+   ASSURE(oFrozen != NULL);
+   ASSURE(SymTableFrozen_getLength(oFrozen) == 0);
+   ASSURE(! SymTableFrozen_contains(oFrozen, "Jeter"));
+   SymTableFrozen_free(oFrozen);
+
+   /* The values come back as their payloads. */
+   iSuccessful = SymTable_put(oSymTable, "Jeter", &aiValues[0]);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTable, "Mantle", &aiValues[1]);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTable, "", &aiValues[2]);
+   ASSURE(iSuccessful);
+   oFrozen = SymTable_freeze(oSymTable);
+   ASSURE(oFrozen != NULL);
+   iSuccessful = SymTableFrozen_save(oFrozen, FILENAME, encodeInt,
+      NULL);
+   ASSURE(iSuccessful);
+   SymTableFrozen_free(oFrozen);
+   oFrozen = SymTable_openMapped(FILENAME);
+   ASSURE(oFrozen != NULL);
+   ASSURE(SymTableFrozen_getLength(oFrozen) == 3);
+   ASSURE((uintptr_t)SymTableFrozen_get(oFrozen, "Jeter") == 7);
+   ASSURE(SymTableFrozen_contains(oFrozen, "Mantle"));
+   ASSURE(SymTableFrozen_get(oFrozen, "Mantle") == NULL);
+   ASSURE((uintptr_t)SymTableFrozen_get(oFrozen, "") == 42);
+   ASSURE(! SymTableFrozen_contains(oFrozen, "Ruth"));
+   SymTableFrozen_map(oFrozen, checkPayload, oSymTable);
+
+   /* Saving over a file that is mapped leaves the mapping as it was,
+      and leaves no temporary file behind. */
+   oSymTable2 = SymTable_new();
+   ASSURE(oSymTable2 != NULL);
+   iSuccessful = SymTable_save(oSymTable2, FILENAME, encodeInt, NULL);
+   ASSURE(iSuccessful);
+   SymTable_free(oSymTable2);
+   ASSURE(SymTableFrozen_getLength(oFrozen) == 3);
+   ASSURE((uintptr_t)SymTableFrozen_get(oFrozen, "Jeter") == 7);
+   SymTableFrozen_free(oFrozen);
+   oFrozen = SymTable_openMapped(FILENAME);
+   ASSURE(oFrozen != NULL);
+   ASSURE(SymTableFrozen_getLength(oFrozen) == 0);
+   SymTableFrozen_free(oFrozen);
+   psFile = fopen(FILENAME ".tmp", "rb");
+   ASSURE(psFile == NULL);
+
+   /* Files that were not saved tables are refused. */
+   ASSURE(SymTable_openMapped("nonexistent.tmp") == NULL);
+   psFile = fopen(FILENAME, "wb");
+   ASSURE(psFile != NULL);
+   fprintf(psFile, "This is not a symbol table.\n");
+   fclose(psFile);
+   ASSURE(SymTable_openMapped(FILENAME) == NULL);
+   iSuccessful = SymTable_save(oSymTable, FILENAME, encodeInt, NULL);
+   ASSURE(iSuccessful);
+   psFile = fopen(FILENAME, "ab");
+   ASSURE(psFile != NULL);
+   fputc('x', psFile);
+   fclose(psFile);
+   ASSURE(SymTable_openMapped(FILENAME) == NULL);
+
+   remove(FILENAME);
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test freezing a table with iBindingCount bindings, and time lookups
+   in the frozen table against lookups in the original. Then time
+   saving the table to a file and mapping it back. */
+
+static void testLargeTable(int iBindingCount)
+{
+   enum {MAX_KEY_LENGTH = 24};
+
+   SymTable_T oSymTable;
+   SymTableFrozen_T oFrozen;
+   char acKey[MAX_KEY_LENGTH];
+   int *piValues;
+   int i;
+   int iSuccessful;
+   clock_t iInitialClock;
+   clock_t iFinalClock;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing a frozen table of %d bindings.\n", iBindingCount);
+   printf("No output except CPU time consumed should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   piValues = (int*)malloc((iBindingCount + 1) * sizeof(int));
+   ASSURE(piValues != NULL);
+   for (i = 0; i < iBindingCount; i++)
+   {
+      piValues[i] = i;
+      sprintf(acKey, "%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, &piValues[i]);
+      ASSURE(iSuccessful);
+   }
+
+   iInitialClock = clock();
+   oFrozen = SymTable_freeze(oSymTable);
+   iFinalClock = clock();
+   ASSURE(oFrozen != NULL);
+   printf("CPU time (freeze): %f seconds\n",
+      ((double)(iFinalClock - iInitialClock)) / CLOCKS_PER_SEC);
+   ASSURE(SymTableFrozen_getLength(oFrozen) == (size_t)iBindingCount);
+   SymTableFrozen_map(oFrozen, checkBinding, oSymTable);
+
+   iInitialClock = clock();
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTableFrozen_get(oFrozen, acKey) == &piValues[i]);
+      sprintf(acKey, "%d", -1 - i);
+      ASSURE(! SymTableFrozen_contains(oFrozen, acKey));
+   }
+   iFinalClock = clock();
+   printf("CPU time (frozen lookups): %f seconds\n",
+      ((double)(iFinalClock - iInitialClock)) / CLOCKS_PER_SEC);
+
+   iInitialClock = clock();
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTable_get(oSymTable, acKey) == &piValues[i]);
+      sprintf(acKey, "%d", -1 - i);
+      ASSURE(! SymTable_contains(oSymTable, acKey));
+   }
+   iFinalClock = clock();
+   printf("CPU time (SymTable lookups): %f seconds\n",
+      ((double)(iFinalClock - iInitialClock)) / CLOCKS_PER_SEC);
+
+   iInitialClock = clock();
+   iSuccessful = SymTableFrozen_save(oFrozen, FILENAME, encodeInt,
+      NULL);
+   iFinalClock = clock();
+   ASSURE(iSuccessful);
+   printf("CPU time (save): %f seconds\n",
+      ((double)(iFinalClock - iInitialClock)) / CLOCKS_PER_SEC);
+   SymTableFrozen_free(oFrozen);
+
+   iInitialClock = clock();
+   oFrozen = SymTable_openMapped(FILENAME);
+   iFinalClock = clock();
+   ASSURE(oFrozen != NULL);
+   printf("CPU time (open mapped): %f seconds\n",
+      ((double)(iFinalClock - iInitialClock)) / CLOCKS_PER_SEC);
+   ASSURE(SymTableFrozen_getLength(oFrozen) == (size_t)iBindingCount);
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE((uintptr_t)SymTableFrozen_get(oFrozen, acKey)
+         == (uintptr_t)i);
+   }
+   remove(FILENAME);
+
+   SymTableFrozen_free(oFrozen);
+   SymTable_free(oSymTable);
+   free(piValues);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the SymTableFrozen ADT. The command-line argument is the
+   number of bindings of the large table. Return 0. */
+
+int main(int argc, char *argv[])
+{
+   int iBindingCount;
+
+   if (argc != 2)
+   {
+      fprintf(stderr, "Usage: %s bindingcount\n", argv[0]);
+      exit(EXIT_FAILURE);
+   }
+
+   if (sscanf(argv[1], "%d", &iBindingCount) != 1)
+   {
+      fprintf(stderr, "bindingcount must be numeric\n");
+      exit(EXIT_FAILURE);
+   }
+   if (iBindingCount < 0)
+   {
+      fprintf(stderr, "bindingcount cannot be negative\n");
+      exit(EXIT_FAILURE);
+   }
+
+   testBasics();
+   testBinaryKeys();
+   testSourceUnchanged();
+   testSave();
+   testLargeTable(iBindingCount);
+
+   printf("------------------------------------------------------\n");
+   printf("End of %s.\n", argv[0]);
+   return 0;
+}
@@ -0,0 +1,447 @@
+/*--------------------------------------------------------------------*/
+/* testsymtableshard.c                                                */
+/* Tests for the sharded symbol table of symtableshard.c, in the      */
+/* style of testsymtable.c.                                           */
+/*--------------------------------------------------------------------*/
+
+#include "symtableshard.h"
+#include "symtable.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <string.h>
+#include <assert.h>
+#include <pthread.h>
+
+/*--------------------------------------------------------------------*/
+
+#define ASSURE(i) assure(i, __LINE__)
+
+/*--------------------------------------------------------------------*/
+
+/* If !iSuccessful, print a message to stdout indicating that the
+   test at line iLineNum failed. */
+
+static void assure(int iSuccessful, int iLineNum)
+{
+   if (! iSuccessful)
+   {
+      printf("Test at line %d failed.\n", iLineNum);
+      fflush(stdout);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* The work of one thread of a concurrent test. */
+
+struct Work
+{
+   /* The table under test. */
+   SymTableShard_T oSymTable;
+
+   /* The number of this thread. */
+   int iThread;
+
+   /* The number of bindings each thread works with. */
+   int iBindingCount;
+
+   /* The values of the bindings that stay in the table throughout. */
+   int *piStable;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Count the binding whose key is pcKey in the int pointed to by
+   pvExtra. pvValue is unused. */
+
+static void countBinding(const char *pcKey, void *pvValue,
+   void *pvExtra)
+{
+   assert(pcKey != NULL);
+   assert(pvExtra != NULL);
+
+   (void)pvValue;
+   (*(int*)pvExtra)++;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the most basic SymTableShard functions on one thread. */
+
+static void testBasics(void)
+{
+   SymTableShard_T oSymTable;
+   char acJeter[] = "Jeter";
+   char acMantle[] = "Mantle";
+   char acShortstop[] = "Shortstop";
+   char acCenterField[] = "Center Field";
+   char *pcValue;
+   int iSuccessful;
+   int iCount;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the basic SymTableShard functions.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTableShard_new(0);
+   ASSURE(oSymTable != NULL);
+   ASSURE(SymTableShard_getLength(oSymTable) == 0);
+
+   iSuccessful = SymTableShard_put(oSymTable, acJeter, acShortstop);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTableShard_put(oSymTable, acMantle, acCenterField);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTableShard_put(oSymTable, acJeter, acCenterField);
+   ASSURE(! iSuccessful);
+   ASSURE(SymTableShard_getLength(oSymTable) == 2);
+
+   ASSURE(SymTableShard_contains(oSymTable, "Jeter"));
+   ASSURE(! SymTableShard_contains(oSymTable, "Ruth"));
+   pcValue = (char*)SymTableShard_get(oSymTable, "Mantle");
+   ASSURE(pcValue == acCenterField);
+   pcValue = (char*)SymTableShard_get(oSymTable, "Ruth");
+   ASSURE(pcValue == NULL);
+
+   pcValue = (char*)SymTableShard_replace(oSymTable, "Mantle",
+      acShortstop);
+   ASSURE(pcValue == acCenterField);
+   pcValue = (char*)SymTableShard_replace(oSymTable, "Ruth",
+      acShortstop);
+   ASSURE(pcValue == NULL);
+   pcValue = (char*)SymTableShard_get(oSymTable, "Mantle");
+   ASSURE(pcValue == acShortstop);
+
+   iCount = 0;
+   SymTableShard_map(oSymTable, countBinding, &iCount);
+   ASSURE(iCount == 2);
+
+   pcValue = (char*)SymTableShard_remove(oSymTable, "Jeter");
+   ASSURE(pcValue == acShortstop);
+   pcValue = (char*)SymTableShard_remove(oSymTable, "Jeter");
+   ASSURE(pcValue == NULL);
+   ASSURE(SymTableShard_getLength(oSymTable) == 1);
+   ASSURE(! SymTableShard_contains(oSymTable, "Jeter"));
+
+   SymTableShard_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the sum of the shard lengths of oSymTable, checking that it
+   has uShardCount shards. */
+
+static size_t sumShardLengths(SymTableShard_T oSymTable,
+   size_t uShardCount)
+{
+   size_t uSum = 0;
+   size_t u;
+
+   assert(oSymTable != NULL);
+
+   ASSURE(SymTableShard_getShardCount(oSymTable) == uShardCount);
+   for (u = 0; u < uShardCount; u++)
+      uSum += SymTableShard_getShardLength(oSymTable, u);
+   return uSum;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test how a SymTableShard splits its bindings: the shard count
+   asked for is rounded up to a power of two, and KEY_COUNT keys spread
+   over all the shards, each getting roughly its share. */
+
+static void testShards(void)
+{
+   enum {SHARD_COUNT = 16, KEY_COUNT = 16000, MAX_KEY_LENGTH = 24};
+
+   SymTableShard_T oSymTable;
+   char acKey[MAX_KEY_LENGTH];
+   static int aiValues[KEY_COUNT];
+   size_t uShardLength;
+   size_t u;
+   int iHashed;
+   int i;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing how SymTableShard spreads its bindings.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   /* Shard counts round up to a power of two, 0 meaning the default
+      of 16, and a count too large to allocate fails. */
+   oSymTable = SymTableShard_new(0);
+   ASSURE(oSymTable != NULL);
+   ASSURE(SymTableShard_getShardCount(oSymTable) == 16);
+   SymTableShard_free(oSymTable);
+   oSymTable = SymTableShard_new(1);
+   ASSURE(oSymTable != NULL);
+   ASSURE(SymTableShard_getShardCount(oSymTable) == 1);
+   SymTableShard_free(oSymTable);
+   oSymTable = SymTableShard_new(3);
+   ASSURE(oSymTable != NULL);
+   ASSURE(SymTableShard_getShardCount(oSymTable) == 4);
+   SymTableShard_free(oSymTable);
+   oSymTable = SymTableShard_new(17);
+   ASSURE(oSymTable != NULL);
+   ASSURE(SymTableShard_getShardCount(oSymTable) == 32);
+   SymTableShard_free(oSymTable);
+   ASSURE(SymTableShard_new((size_t)-1) == NULL);
+
+   /* symtablelist.c gives every key the hash code 0, and so puts
+      every key in shard 0. */
+   iHashed = SymTable_hashKey("Jeter").uHash
+      != SymTable_hashKey("Mantle").uHash;
+
+   /* A table of one shard holds everything in it. */
+   oSymTable = SymTableShard_new(1);
+   ASSURE(oSymTable != NULL);
+   for (i = 0; i < 100; i++)
+   {
+      sprintf(acKey, "k%d", i);
+      iSuccessful = SymTableShard_put(oSymTable, acKey, &aiValues[i]);
+      ASSURE(iSuccessful);
+   }
+   ASSURE(SymTableShard_getShardLength(oSymTable, 0) == 100);
+   SymTableShard_free(oSymTable);
+
+   /* Every shard gets between half and twice its share of the keys,
+      and the shard lengths add up to the length of the table as
+      bindings come and go. */
+   oSymTable = SymTableShard_new(SHARD_COUNT);
+   ASSURE(oSymTable != NULL);
+   for (i = 0; i < KEY_COUNT; i++)
+   {
+      sprintf(acKey, "k%d", i);
+      iSuccessful = SymTableShard_put(oSymTable, acKey, &aiValues[i]);
+      ASSURE(iSuccessful);
+   }
+   ASSURE(sumShardLengths(oSymTable, SHARD_COUNT) == KEY_COUNT);
+   for (u = 0; u < SHARD_COUNT; u++)
+   {
+      uShardLength = SymTableShard_getShardLength(oSymTable, u);
+      if (iHashed)
+         ASSURE(uShardLength > KEY_COUNT / SHARD_COUNT / 2
+            && uShardLength < KEY_COUNT / SHARD_COUNT * 2);
+      else
+         ASSURE(uShardLength == (u == 0 ? (size_t)KEY_COUNT : 0));
+   }
+   for (i = 0; i < KEY_COUNT; i += 2)
+   {
+      sprintf(acKey, "k%d", i);
+      ASSURE(SymTableShard_remove(oSymTable, acKey) == &aiValues[i]);
+   }
+   ASSURE(sumShardLengths(oSymTable, SHARD_COUNT) == KEY_COUNT / 2);
+   ASSURE(SymTableShard_getLength(oSymTable) == KEY_COUNT / 2);
+   for (i = 1; i < KEY_COUNT; i += 2)
+   {
+      sprintf(acKey, "k%d", i);
+      ASSURE(SymTableShard_get(oSymTable, acKey) == &aiValues[i]);
+   }
+   SymTableShard_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Put, check and remove the bindings of the thread described by
+   pvWork, whose keys no other thread uses, twice over. */
+
+static void *writeBindings(void *pvWork)
+{
+   enum {MAX_KEY_LENGTH = 24};
+
+   struct Work *psWork = (struct Work*)pvWork;
+   char acKey[MAX_KEY_LENGTH];
+   int iRound;
+   int i;
+   int iSuccessful;
+
+   for (iRound = 0; iRound < 2; iRound++)
+   {
+      for (i = 0; i < psWork->iBindingCount; i++)
+      {
+         sprintf(acKey, "w%d.%d", psWork->iThread, i);
+         iSuccessful = SymTableShard_put(psWork->oSymTable, acKey,
+            &psWork->piStable[i]);
+         ASSURE(iSuccessful);
+      }
+      for (i = 0; i < psWork->iBindingCount; i++)
+      {
+         sprintf(acKey, "w%d.%d", psWork->iThread, i);
+         ASSURE(SymTableShard_get(psWork->oSymTable, acKey)
+            == &psWork->piStable[i]);
+      }
+      for (i = 0; i < psWork->iBindingCount; i += 2)
+      {
+         sprintf(acKey, "w%d.%d", psWork->iThread, i);
+         ASSURE(SymTableShard_remove(psWork->oSymTable, acKey)
+            == &psWork->piStable[i]);
+      }
+      for (i = 1; i < psWork->iBindingCount; i += 2)
+      {
+         sprintf(acKey, "w%d.%d", psWork->iThread, i);
+         ASSURE(SymTableShard_remove(psWork->oSymTable, acKey)
+            == &psWork->piStable[i]);
+      }
+   }
+   return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Look up the stable bindings of the table described by pvWork
+   READ_ROUNDS times, as many passes as a writer makes over its own
+   bindings, so that the readers do a fixed amount of work rather than
+   spin until the writers are done. Every lookup must succeed, however
+   the writers change the rest of the table. */
+
+static void *readBindings(void *pvWork)
+{
+   enum {MAX_KEY_LENGTH = 24, READ_ROUNDS = 8};
+
+   struct Work *psWork = (struct Work*)pvWork;
+   char acKey[MAX_KEY_LENGTH];
+   int iRound;
+   int i;
+
+   for (iRound = 0; iRound < READ_ROUNDS; iRound++)
+   {
+      for (i = 0; i < psWork->iBindingCount; i++)
+      {
+         sprintf(acKey, "s%d", i);
+         ASSURE(SymTableShard_get(psWork->oSymTable, acKey)
+            == &psWork->piStable[i]);
+      }
+   }
+   return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test iThreadCount writer threads and as many reader threads sharing
+   one table, each writer with iBindingCount bindings of its own, while
+   the readers look up iBindingCount bindings that stay put. */
+
+static void testThreads(int iThreadCount, int iBindingCount)
+{
+   enum {MAX_KEY_LENGTH = 24};
+
+   SymTableShard_T oSymTable;
+   pthread_t *psWriters;
+   pthread_t *psReaders;
+   struct Work *psWriterWork;
+   struct Work sReaderWork;
+   char acKey[MAX_KEY_LENGTH];
+   int *piStable;
+   int iCount;
+   int i;
+   int iSuccessful;
+   clock_t iInitialClock;
+   clock_t iFinalClock;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing %d writer and %d reader threads.\n", iThreadCount,
+      iThreadCount);
+   printf("No output except CPU time consumed should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTableShard_new(4 * iThreadCount);
+   ASSURE(oSymTable != NULL);
+   psWriters = (pthread_t*)malloc(iThreadCount * sizeof(pthread_t));
+   psReaders = (pthread_t*)malloc(iThreadCount * sizeof(pthread_t));
+   psWriterWork = (struct Work*)malloc(iThreadCount
+      * sizeof(struct Work));
+   piStable = (int*)malloc((iBindingCount + 1) * sizeof(int));
+   ASSURE(psWriters != NULL && psReaders != NULL
+      && psWriterWork != NULL && piStable != NULL);
+
+   for (i = 0; i < iBindingCount; i++)
+   {
+      piStable[i] = i;
+      sprintf(acKey, "s%d", i);
+      iSuccessful = SymTableShard_put(oSymTable, acKey, &piStable[i]);
+      ASSURE(iSuccessful);
+   }
+
+   iInitialClock = clock();
+
+   sReaderWork.oSymTable = oSymTable;
+   sReaderWork.iThread = -1;
+   sReaderWork.iBindingCount = iBindingCount;
+   sReaderWork.piStable = piStable;
+   for (i = 0; i < iThreadCount; i++)
+   {
+      psWriterWork[i] = sReaderWork;
+      psWriterWork[i].iThread = i;
+      iSuccessful = pthread_create(&psReaders[i], NULL, readBindings,
+         &sReaderWork) == 0;
+      ASSURE(iSuccessful);
+      iSuccessful = pthread_create(&psWriters[i], NULL, writeBindings,
+         &psWriterWork[i]) == 0;
+      ASSURE(iSuccessful);
+   }
+   for (i = 0; i < iThreadCount; i++)
+   {
+      pthread_join(psWriters[i], NULL);
+      pthread_join(psReaders[i], NULL);
+   }
+
+   iFinalClock = clock();
+
+   /* Only the stable bindings are left. */
+   ASSURE(SymTableShard_getLength(oSymTable) == (size_t)iBindingCount);
+   iCount = 0;
+   SymTableShard_map(oSymTable, countBinding, &iCount);
+   ASSURE(iCount == iBindingCount);
+
+   SymTableShard_free(oSymTable);
+   free(piStable);
+   free(psWriterWork);
+   free(psReaders);
+   free(psWriters);
+
+   printf("CPU time (%d threads, %d bindings): %f seconds\n",
+      2 * iThreadCount, iBindingCount,
+      ((double)(iFinalClock - iInitialClock)) / CLOCKS_PER_SEC);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the SymTableShard ADT. The first command-line argument is the
+   number of bindings each thread works with, and the second the
+   number of writer threads. Return 0. */
+
+int main(int argc, char *argv[])
+{
+   int iBindingCount;
+   int iThreadCount;
+
+   if (argc != 3)
+   {
+      fprintf(stderr, "Usage: %s bindingcount threadcount\n", argv[0]);
+      exit(EXIT_FAILURE);
+   }
+
+   if (sscanf(argv[1], "%d", &iBindingCount) != 1
+      || sscanf(argv[2], "%d", &iThreadCount) != 1)
+   {
+      fprintf(stderr, "bindingcount and threadcount must be numeric\n");
+      exit(EXIT_FAILURE);
+   }
+   if (iBindingCount < 0 || iThreadCount < 1)
+   {
+      fprintf(stderr, "bindingcount cannot be negative and "
+         "threadcount must be positive\n");
+      exit(EXIT_FAILURE);
+   }
+
+   testBasics();
+   testShards();
+   testThreads(iThreadCount, iBindingCount);
+
+   printf("------------------------------------------------------\n");
+   printf("End of %s.\n", argv[0]);
+   return 0;
+}